@@ -0,0 +1,289 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+#include "MrmsBufferPool.h"
+
+using namespace std;
+
+
+// C O N S T A N T S
+
+//smallest size class; also the alignment of every buffer
+static const size_t MIN_CLASS_BYTES = 4096;
+
+//transparent huge page size
+static const size_t HUGE_PAGE_BYTES = 2*1024*1024;
+
+
+
+/*****************************/
+/*****************************/
+/** C O N S T R U C T O R S **/
+/*****************************/
+
+//default constructor
+MrmsBufferPool::MrmsBufferPool()
+{
+    idleTotal = 0;
+    maxIdle = SIZE_MAX;
+    allocations = 0;
+    useHugePages = false;
+}
+
+
+//deconstructor; buffers still handed out are not freed
+MrmsBufferPool::~MrmsBufferPool()
+{
+    trim();
+}
+
+/************************************/
+/** E N D  C O N S T R U C T O R S **/
+/************************************/
+/************************************/
+
+
+
+/********************************/
+/********************************/
+/** P U B L I C  M E T H O D S **/
+/********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		acquire
+
+	Purpose:	Get a buffer of at least num_bytes, reusing an idle
+	            one of the same size class when there is one.  The
+	            contents are undefined.
+
+	Output:		buffer, or 0 if out of memory
+
+------------------------------------------------------------------*/
+
+void* MrmsBufferPool::acquire(size_t num_bytes)
+{
+    lock_guard< mutex > lock(guard);
+
+    size_t size_class = sizeClass(num_bytes, useHugePages);
+    void *buf = 0;
+
+    map<size_t, vector<void*> >::iterator found = idle.find(size_class);
+    if( (found != idle.end()) && !found->second.empty() )
+    {
+      buf = found->second.back();
+      found->second.pop_back();
+      idleTotal -= size_class;
+    }
+    else
+    {
+      bool huge = useHugePages && (size_class >= HUGE_PAGE_BYTES);
+      size_t align = huge ? HUGE_PAGE_BYTES : MIN_CLASS_BYTES;
+
+      if( posix_memalign(&buf, align, size_class) != 0 ) return 0;
+
+      if(huge) madvise(buf, size_class, MADV_HUGEPAGE);
+      allocations++;
+    }
+
+    inUse[buf] = size_class;
+
+    return buf;
+
+}//end public method MrmsBufferPool::acquire
+
+
+/*------------------------------------------------------------------
+
+	Method:		release
+
+	Purpose:	Give a buffer from acquire back to the pool.  It is
+	            freed instead if the pool already holds
+	            setMaxIdleBytes of idle buffers.
+
+------------------------------------------------------------------*/
+
+void MrmsBufferPool::release(void *buf)
+{
+    if(buf == 0) return;
+
+    lock_guard< mutex > lock(guard);
+
+    map<void*, size_t>::iterator found = inUse.find(buf);
+    if(found == inUse.end()) return;   //not ours
+
+    size_t size_class = found->second;
+    inUse.erase(found);
+
+    if(idleTotal + size_class > maxIdle)
+    {
+      free(buf);
+      return;
+    }
+
+    idle[size_class].push_back(buf);
+    idleTotal += size_class;
+
+}//end public method MrmsBufferPool::release
+
+
+/*------------------------------------------------------------------
+
+	Method:		setHugePages, hugePages
+
+	Purpose:	Whether new buffers of 2 MB or more use
+	            transparent huge pages.  Buffers already in the
+	            pool are not changed.
+
+------------------------------------------------------------------*/
+
+void MrmsBufferPool::setHugePages(bool huge_pages)
+{
+    lock_guard< mutex > lock(guard);
+    useHugePages = huge_pages;
+
+}//end public method MrmsBufferPool::setHugePages
+
+
+bool MrmsBufferPool::hugePages() const
+{
+    lock_guard< mutex > lock(guard);
+    return useHugePages;
+
+}//end public method MrmsBufferPool::hugePages
+
+
+/*------------------------------------------------------------------
+
+	Method:		setMaxIdleBytes
+
+	Purpose:	Limit on the bytes kept in idle buffers (default:
+	            no limit).  Idle buffers over the new limit are
+	            freed, largest first.
+
+------------------------------------------------------------------*/
+
+void MrmsBufferPool::setMaxIdleBytes(size_t max_bytes)
+{
+    lock_guard< mutex > lock(guard);
+    maxIdle = max_bytes;
+
+    map<size_t, vector<void*> >::reverse_iterator size_class = idle.rbegin();
+
+    while( (idleTotal > maxIdle) && (size_class != idle.rend()) )
+    {
+      if(size_class->second.empty())
+      {
+        ++size_class;
+        continue;
+      }
+
+      free(size_class->second.back());
+      size_class->second.pop_back();
+      idleTotal -= size_class->first;
+    }
+
+}//end public method MrmsBufferPool::setMaxIdleBytes
+
+
+/*------------------------------------------------------------------
+
+	Method:		idleBytes, numAllocations
+
+	Purpose:	Bytes held in idle buffers, and the number of
+	            buffers the pool has had to allocate so far
+
+------------------------------------------------------------------*/
+
+size_t MrmsBufferPool::idleBytes() const
+{
+    lock_guard< mutex > lock(guard);
+    return idleTotal;
+
+}//end public method MrmsBufferPool::idleBytes
+
+
+size_t MrmsBufferPool::numAllocations() const
+{
+    lock_guard< mutex > lock(guard);
+    return allocations;
+
+}//end public method MrmsBufferPool::numAllocations
+
+
+/*------------------------------------------------------------------
+
+	Method:		trim
+
+	Purpose:	Free every idle buffer
+
+------------------------------------------------------------------*/
+
+void MrmsBufferPool::trim()
+{
+    lock_guard< mutex > lock(guard);
+
+    map<size_t, vector<void*> >::iterator size_class;
+    for(size_class = idle.begin(); size_class != idle.end(); ++size_class)
+    {
+      for(size_t b = 0; b < size_class->second.size(); b++)
+        free(size_class->second[b]);
+    }
+
+    idle.clear();
+    idleTotal = 0;
+
+}//end public method MrmsBufferPool::trim
+
+
+/*------------------------------------------------------------------
+
+	Method:		sizeClass
+
+	Purpose:	Size actually allocated for a request: the next
+	            multiple of a quarter of the power of two below
+	            it (so 5, 6, 7 or 8 MB above 4 MB), and whole huge
+	            pages when they are used
+
+------------------------------------------------------------------*/
+
+size_t MrmsBufferPool::sizeClass(size_t num_bytes, bool huge_pages)
+{
+    if(num_bytes <= MIN_CLASS_BYTES) return MIN_CLASS_BYTES;
+
+    size_t power = MIN_CLASS_BYTES;
+    while(power < (num_bytes-1)/2 + 1) power *= 2;
+
+    size_t step = power/4;
+    size_t size_class = ( (num_bytes + step - 1)/step ) * step;
+
+    if( huge_pages && (size_class >= HUGE_PAGE_BYTES) )
+      size_class = ( (size_class + HUGE_PAGE_BYTES - 1)/HUGE_PAGE_BYTES ) * HUGE_PAGE_BYTES;
+
+    return size_class;
+
+}//end public method MrmsBufferPool::sizeClass
+
+
+/*------------------------------------------------------------------
+
+	Method:		shared
+
+	Purpose:	Pool shared by the whole process
+
+------------------------------------------------------------------*/
+
+MrmsBufferPool& MrmsBufferPool::shared()
+{
+    static MrmsBufferPool pool;
+    return pool;
+
+}//end public method MrmsBufferPool::shared
+
+/***************************************/
+/** E N D  P U B L I C  M E T H O D S **/
+/***************************************/
+/***************************************/
+
+//End Class MrmsBufferPool
@@ -0,0 +1,774 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#if defined(__NR_io_uring_setup) && defined(IORING_FEAT_RW_CUR_POS)
+#define MRMS_HAVE_IO_URING
+#endif
+#endif
+#endif
+
+#include "MrmsFileQueue.h"
+
+using namespace std;
+
+
+// C O N S T A N T S
+
+//most files read ahead at once
+static const int MAX_DEPTH = 256;
+
+//largest count handed to one read request
+static const size_t MAX_READ_BYTES = (size_t)1 << 30;
+
+//request kinds, kept in the low bits of each request's user_data
+//(the rest is the slot, or the fd for a close)
+enum { OP_OPEN = 0, OP_STAT = 1, OP_READ = 2, OP_CLOSE = 3 };
+
+
+
+// T Y P E S
+
+#ifdef MRMS_HAVE_IO_URING
+
+//Submission and completion rings shared with the kernel
+struct MrmsFileRing
+{
+    int fd;
+
+    void *sqMap, *cqMap;
+    size_t sqMapBytes, cqMapBytes;
+    struct io_uring_sqe *sqes;
+    size_t sqesBytes;
+
+    unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+    unsigned sqEntries;
+    unsigned *cqHead, *cqTail, *cqMask;
+    struct io_uring_cqe *cqes;
+
+    unsigned toSubmit;             //queued, not yet given to the kernel
+    unsigned inFlight;             //queued, not yet completed
+    bool draining;                 //closing: start nothing new
+
+    vector<struct statx> stx;      //one per slot
+};
+
+#else
+
+struct MrmsFileRing
+{
+};
+
+#endif
+
+
+
+// F U N C T I O N S
+
+#ifdef MRMS_HAVE_IO_URING
+
+/*------------------------------------------------------------------
+
+	Function:	queue_request
+
+	Purpose:	Fill in the next submission queue entry.  It goes
+	            to the kernel with the next io_uring_enter.
+
+	Output:		io_uring_sqe* to set any further fields in, or 0
+	            if the submission queue is full
+
+------------------------------------------------------------------*/
+
+static struct io_uring_sqe* queue_request(MrmsFileRing *ring,
+                                          int opcode, int fd,
+                                          const void *addr, unsigned len,
+                                          unsigned long long offset,
+                                          unsigned long long user_data)
+{
+    unsigned head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+    unsigned tail = *ring->sqTail;
+
+    if(tail - head >= ring->sqEntries) return 0;
+
+    unsigned index = tail & *ring->sqMask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = (unsigned long long)(uintptr_t)addr;
+    sqe->len = len;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+
+    ring->sqArray[index] = index;
+    __atomic_store_n(ring->sqTail, tail+1, __ATOMIC_RELEASE);
+
+    ring->toSubmit++;
+    ring->inFlight++;
+
+    return sqe;
+}
+
+#endif
+
+
+
+/*****************************/
+/*****************************/
+/** C O N S T R U C T O R S **/
+/*****************************/
+
+//default constructor
+MrmsFileQueue::MrmsFileQueue()
+{
+    ring = 0;
+    nextFile = 0;
+    nextStart = 0;
+    current = -1;
+}
+
+
+//destructor
+MrmsFileQueue::~MrmsFileQueue()
+{
+    close();
+}
+
+/************************************/
+/** E N D  C O N S T R U C T O R S **/
+/************************************/
+/************************************/
+
+
+
+/********************************/
+/********************************/
+/** P U B L I C  M E T H O D S **/
+/********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		open
+
+	Purpose:	Start reading vfnames, up to depth files at a time.
+	            Files that cannot be read are reported by next(),
+	            in their turn.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsFileQueue::open(const vector<string> &vfnames, int depth)
+{
+    close();
+    errorText.clear();
+
+    if(depth < 1) depth = 1;
+    if(depth > MAX_DEPTH) depth = MAX_DEPTH;
+
+    files = vfnames;
+    if(slots.size() != (size_t)depth) slots.resize(depth);
+
+    for(size_t s = 0; s < slots.size(); s++)
+    {
+      slots[s].fd = -1;
+      slots[s].status = 0;
+      slots[s].waiting = 0;
+    }
+
+    //synchronous reads if there is no io_uring to be had
+    openRing(depth);
+
+    return 1;
+
+}//end public method MrmsFileQueue::open
+
+
+/*------------------------------------------------------------------
+
+	Method:		next
+
+	Purpose:	Move to the next file in the list, waiting for its
+	            read to finish, and start reading the files after
+	            it.  The previous file's bytes are given up.
+
+	Output:		int indicating the file was read (1), the end of
+	            the list (0), or that this file could not be read
+	            (-1; see errorMessage, and call next again for the
+	            file after it)
+
+------------------------------------------------------------------*/
+
+int MrmsFileQueue::next()
+{
+    current = -1;
+    fileText.clear();
+    errorText.clear();
+
+    if(nextFile >= files.size()) return 0;
+
+
+    //The slot handed out last is free again, so the queue moves up
+    //by one file
+    size_t depth = slots.size();
+
+    while( (nextStart < files.size()) && (nextStart < nextFile + depth) )
+      start(nextStart++);
+
+    int s = nextFile % depth;
+    Slot &slot = slots[s];
+    fileText = files[nextFile++];
+
+    if(ring == 0) readFile(slot);
+#ifdef MRMS_HAVE_IO_URING
+    else
+    {
+      while(slot.status == 0)
+      {
+        if(submit(1) < 0)
+        {
+          finish(slot, -1, string("io_uring_enter failed: ") + strerror(errno));
+          break;
+        }
+      }
+
+      //Requests queued while waiting (reads of files whose open
+      //just finished) go out now, to run while this file is decoded
+      if(ring->toSubmit > 0) submit(0);
+    }
+#endif
+
+    current = s;
+
+    if(slot.status < 0)
+    {
+      errorText = slot.error;
+      return -1;
+    }
+
+    return 1;
+
+}//end public method MrmsFileQueue::next
+
+
+/*------------------------------------------------------------------
+
+	Method:		data, size
+
+	Purpose:	Bytes of the current file (0 and 0 before the first
+	            next, after the last, or if the file failed)
+
+------------------------------------------------------------------*/
+
+const unsigned char* MrmsFileQueue::data() const
+{
+    if( (current < 0) || (slots[current].status < 1) ) return 0;
+
+    return slots[current].bytes.data();
+
+}//end public method MrmsFileQueue::data
+
+
+size_t MrmsFileQueue::size() const
+{
+    if( (current < 0) || (slots[current].status < 1) ) return 0;
+
+    return slots[current].size;
+
+}//end public method MrmsFileQueue::size
+
+
+/*------------------------------------------------------------------
+
+	Method:		close
+
+	Purpose:	Stop reading: wait for requests already with the
+	            kernel and close their files.  Slot buffers are
+	            kept for reuse.
+
+------------------------------------------------------------------*/
+
+void MrmsFileQueue::close()
+{
+    closeRing();
+
+    for(size_t s = 0; s < slots.size(); s++)
+    {
+      if(slots[s].fd >= 0) ::close(slots[s].fd);
+      slots[s].fd = -1;
+    }
+
+    files.clear();
+    nextFile = 0;
+    nextStart = 0;
+    current = -1;
+    fileText.clear();
+
+}//end public method MrmsFileQueue::close
+
+/***************************************/
+/** E N D  P U B L I C  M E T H O D S **/
+/***************************************/
+/***************************************/
+
+
+
+/**********************************/
+/**********************************/
+/** P R I V A T E  M E T H O D S **/
+/**********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		openRing
+
+	Purpose:	Set up an io_uring with room for depth files, and
+	            check the kernel has the requests used here
+	            (openat, statx, read, close: Linux 5.6 and later)
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsFileQueue::openRing(int depth)
+{
+#ifdef MRMS_HAVE_IO_URING
+    //Each file has at most two requests out (open and statx) and
+    //a close may trail behind
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int ring_fd = syscall(__NR_io_uring_setup, 4*depth, &params);
+    if(ring_fd < 0) return -1;
+
+
+    //Requests needed
+    size_t probe_bytes = sizeof(struct io_uring_probe)
+                       + 256*sizeof(struct io_uring_probe_op);
+    vector<unsigned char> probe_buf(probe_bytes, 0);
+    struct io_uring_probe *probe = (struct io_uring_probe *)probe_buf.data();
+
+    int ops[] = { IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ,
+                  IORING_OP_CLOSE };
+    bool supported =
+      (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE,
+               probe, 256) == 0);
+
+    for(size_t o = 0; supported && (o < 4); o++)
+    {
+      supported = (ops[o] <= probe->last_op) &&
+                  (probe->ops[ops[o]].flags & IO_URING_OP_SUPPORTED);
+    }
+
+    if( !supported || !(params.features & IORING_FEAT_NODROP) )
+    {
+      ::close(ring_fd);
+      return -1;
+    }
+
+
+    //Map the rings
+    MrmsFileRing *r = new MrmsFileRing;
+    r->fd = ring_fd;
+    r->sqMapBytes = params.sq_off.array + params.sq_entries*sizeof(unsigned);
+    r->cqMapBytes = params.cq_off.cqes
+                  + params.cq_entries*sizeof(struct io_uring_cqe);
+    r->sqesBytes = params.sq_entries*sizeof(struct io_uring_sqe);
+
+    bool single_map = (params.features & IORING_FEAT_SINGLE_MMAP);
+    if(single_map)
+    {
+      if(r->cqMapBytes > r->sqMapBytes) r->sqMapBytes = r->cqMapBytes;
+      r->cqMapBytes = r->sqMapBytes;
+    }
+
+    r->sqMap = mmap(0, r->sqMapBytes, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    r->cqMap = single_map ? r->sqMap :
+               mmap(0, r->cqMapBytes, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+    void *sqes = mmap(0, r->sqesBytes, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+
+    if( (r->sqMap == MAP_FAILED) || (r->cqMap == MAP_FAILED) ||
+        (sqes == MAP_FAILED) )
+    {
+      if(r->sqMap != MAP_FAILED) munmap(r->sqMap, r->sqMapBytes);
+      if( !single_map && (r->cqMap != MAP_FAILED) )
+        munmap(r->cqMap, r->cqMapBytes);
+      if(sqes != MAP_FAILED) munmap(sqes, r->sqesBytes);
+      ::close(ring_fd);
+      delete r;
+      return -1;
+    }
+
+    unsigned char *sq = (unsigned char *)r->sqMap;
+    unsigned char *cq = (unsigned char *)r->cqMap;
+
+    r->sqes = (struct io_uring_sqe *)sqes;
+    r->sqHead = (unsigned *)(sq + params.sq_off.head);
+    r->sqTail = (unsigned *)(sq + params.sq_off.tail);
+    r->sqMask = (unsigned *)(sq + params.sq_off.ring_mask);
+    r->sqArray = (unsigned *)(sq + params.sq_off.array);
+    r->sqEntries = params.sq_entries;
+    r->cqHead = (unsigned *)(cq + params.cq_off.head);
+    r->cqTail = (unsigned *)(cq + params.cq_off.tail);
+    r->cqMask = (unsigned *)(cq + params.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    r->toSubmit = 0;
+    r->inFlight = 0;
+    r->draining = false;
+    r->stx.resize(depth);
+
+    ring = r;
+
+    return 1;
+#else
+    (void)depth;
+    return -1;
+#endif
+
+}//end private method MrmsFileQueue::openRing
+
+
+/*------------------------------------------------------------------
+
+	Method:		closeRing
+
+	Purpose:	Wait out the requests still in flight (the kernel
+	            may be writing into slot buffers), then tear the
+	            ring down
+
+------------------------------------------------------------------*/
+
+void MrmsFileQueue::closeRing()
+{
+#ifdef MRMS_HAVE_IO_URING
+    if(ring == 0) return;
+
+    ring->draining = true;
+
+    while(ring->inFlight > 0)
+    {
+      if(submit(1) < 0) break;
+    }
+
+    munmap(ring->sqes, ring->sqesBytes);
+    if(ring->cqMap != ring->sqMap) munmap(ring->cqMap, ring->cqMapBytes);
+    munmap(ring->sqMap, ring->sqMapBytes);
+    ::close(ring->fd);
+
+    delete ring;
+    ring = 0;
+#endif
+
+}//end private method MrmsFileQueue::closeRing
+
+
+/*------------------------------------------------------------------
+
+	Method:		start
+
+	Purpose:	Start reading a file into its slot: queue its open
+	            and statx (synchronous reads start in next)
+
+------------------------------------------------------------------*/
+
+void MrmsFileQueue::start(size_t file)
+{
+    size_t s = file % slots.size();
+    Slot &slot = slots[s];
+
+    slot.file = file;
+    slot.fd = -1;
+    slot.size = 0;
+    slot.done = 0;
+    slot.waiting = 0;
+    slot.status = 0;
+    slot.error.clear();
+
+#ifdef MRMS_HAVE_IO_URING
+    if(ring == 0) return;
+
+    //Room is made for both by sending what is queued
+    if( (ring->sqEntries - ring->toSubmit < 2) && (submit(0) < 0) )
+    {
+      finish(slot, -1, string("io_uring_enter failed: ") + strerror(errno));
+      return;
+    }
+
+    const char *path = files[file].c_str();
+
+    struct io_uring_sqe *sqe =
+      queue_request(ring, IORING_OP_OPENAT, AT_FDCWD, path, 0, 0,
+                    (s << 2) | OP_OPEN);
+    sqe->open_flags = O_RDONLY | O_CLOEXEC;
+
+    sqe = queue_request(ring, IORING_OP_STATX, AT_FDCWD, path, STATX_SIZE,
+                        (unsigned long long)(uintptr_t)&ring->stx[s],
+                        (s << 2) | OP_STAT);
+    sqe->statx_flags = 0;
+
+    slot.waiting = 2;
+#endif
+
+}//end private method MrmsFileQueue::start
+
+
+/*------------------------------------------------------------------
+
+	Method:		complete
+
+	Purpose:	Act on one finished request: once a file's open
+	            and statx are both done, queue its read; once the
+	            read is done, queue its close
+
+------------------------------------------------------------------*/
+
+void MrmsFileQueue::complete(unsigned long long user_data, int result)
+{
+#ifdef MRMS_HAVE_IO_URING
+    int op = (int)(user_data & 3);
+
+    //nothing waits on a close
+    if(op == OP_CLOSE) return;
+
+    Slot &slot = slots[user_data >> 2];
+    slot.waiting--;
+
+    if(ring->draining)
+    {
+      if( (op == OP_OPEN) && (result >= 0) ) ::close(result);
+      return;
+    }
+
+    const string &path = files[slot.file];
+    string error;
+
+    if(op == OP_OPEN)
+    {
+      if(result < 0) error = "Could not open " + path + ": " + strerror(-result);
+      else slot.fd = result;
+    }
+    else if(op == OP_STAT)
+    {
+      if(result < 0) error = "Could not stat " + path + ": " + strerror(-result);
+      else slot.size = ring->stx[user_data >> 2].stx_size;
+    }
+    else if( (result == -EINTR) || (result == -EAGAIN) )
+    {
+      //read again below
+    }
+    else if(result < 0) error = "Could not read " + path + ": " + strerror(-result);
+    else if(result == 0) slot.size = slot.done;     //file got shorter
+    else slot.done += result;
+
+    //the first error is the one reported
+    if( !error.empty() && slot.error.empty() ) slot.error = error;
+
+    if(slot.waiting > 0) return;
+
+    if( !slot.error.empty() )
+    {
+      finish(slot, -1, slot.error);
+      return;
+    }
+
+
+    //Read (the rest of) the file
+    if(slot.done < slot.size)
+    {
+      if(slot.bytes.size() < slot.size) slot.bytes.resize(slot.size);
+
+      size_t num_bytes = slot.size - slot.done;
+      if(num_bytes > MAX_READ_BYTES) num_bytes = MAX_READ_BYTES;
+
+      if( (ring->sqEntries - ring->toSubmit < 1) && (submit(0) < 0) )
+      {
+        finish(slot, -1, string("io_uring_enter failed: ") + strerror(errno));
+        return;
+      }
+
+      queue_request(ring, IORING_OP_READ, slot.fd,
+                    slot.bytes.data() + slot.done, (unsigned)num_bytes,
+                    slot.done, ((&slot - &slots[0]) << 2) | OP_READ);
+      slot.waiting = 1;
+      return;
+    }
+
+    finish(slot, 1, "");
+#else
+    (void)user_data;
+    (void)result;
+#endif
+
+}//end private method MrmsFileQueue::complete
+
+
+/*------------------------------------------------------------------
+
+	Method:		submit
+
+	Purpose:	Give the kernel the queued requests, wait for at
+	            least wait_for of them to complete, and act on every
+	            completion there is
+
+	Output:		int indicating success (1) or failure (-1; errno
+	            is set)
+
+------------------------------------------------------------------*/
+
+int MrmsFileQueue::submit(int wait_for)
+{
+#ifdef MRMS_HAVE_IO_URING
+    unsigned flags = (wait_for > 0) ? IORING_ENTER_GETEVENTS : 0;
+
+    while(true)
+    {
+      int num_submitted = syscall(__NR_io_uring_enter, ring->fd,
+                                  ring->toSubmit, wait_for, flags, NULL, 0);
+
+      if(num_submitted >= 0)
+      {
+        ring->toSubmit -= num_submitted;
+        break;
+      }
+
+      //EBUSY/EAGAIN: completions must be reaped first
+      if( (errno != EINTR) && (errno != EBUSY) && (errno != EAGAIN) )
+        return -1;
+
+      if(errno != EINTR) break;
+    }
+
+
+    //Completions
+    unsigned head = *ring->cqHead;
+
+    while( head != __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE) )
+    {
+      struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cqMask];
+      unsigned long long user_data = cqe->user_data;
+      int result = cqe->res;
+
+      head++;
+      __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+      ring->inFlight--;
+
+      complete(user_data, result);
+    }
+
+    return 1;
+#else
+    (void)wait_for;
+    return -1;
+#endif
+
+}//end private method MrmsFileQueue::submit
+
+
+/*------------------------------------------------------------------
+
+	Method:		finish
+
+	Purpose:	Mark a slot read (1) or failed (-1) and close its
+	            file, through the ring if there is one
+
+------------------------------------------------------------------*/
+
+void MrmsFileQueue::finish(Slot &slot, int status, const string &error)
+{
+    slot.status = status;
+    slot.error = error;
+
+    if(slot.fd < 0) return;
+
+#ifdef MRMS_HAVE_IO_URING
+    if( (ring != 0) && (ring->sqEntries - ring->toSubmit > 0) )
+    {
+      queue_request(ring, IORING_OP_CLOSE, slot.fd, 0, 0, 0,
+                    ((unsigned long long)slot.fd << 2) | OP_CLOSE);
+      slot.fd = -1;
+      return;
+    }
+#endif
+
+    ::close(slot.fd);
+    slot.fd = -1;
+
+}//end private method MrmsFileQueue::finish
+
+
+/*------------------------------------------------------------------
+
+	Method:		readFile
+
+	Purpose:	Read a slot's file whole, here and now (no ring)
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsFileQueue::readFile(Slot &slot)
+{
+    const string &path = files[slot.file];
+
+    slot.fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(slot.fd < 0)
+    {
+      finish(slot, -1, "Could not open " + path + ": " + strerror(errno));
+      return -1;
+    }
+
+    struct stat st;
+    if(fstat(slot.fd, &st) < 0)
+    {
+      finish(slot, -1, "Could not stat " + path + ": " + strerror(errno));
+      return -1;
+    }
+
+    slot.size = (size_t)st.st_size;
+    if(slot.bytes.size() < slot.size) slot.bytes.resize(slot.size);
+
+    while(slot.done < slot.size)
+    {
+      ssize_t num_read = ::read(slot.fd, slot.bytes.data() + slot.done,
+                                slot.size - slot.done);
+
+      if( (num_read < 0) && (errno == EINTR) ) continue;
+
+      if(num_read < 0)
+      {
+        finish(slot, -1, "Could not read " + path + ": " + strerror(errno));
+        return -1;
+      }
+
+      //file got shorter
+      if(num_read == 0) slot.size = slot.done;
+
+      slot.done += num_read;
+    }
+
+    finish(slot, 1, "");
+
+    return 1;
+
+}//end private method MrmsFileQueue::readFile
+
+/*****************************************/
+/** E N D  P R I V A T E  M E T H O D S **/
+/*****************************************/
+/*****************************************/
+
+//End Class MrmsFileQueue
@@ -0,0 +1,121 @@
+#ifndef MRMSFILEQUEUE_H
+#define MRMSFILEQUEUE_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	File:		MrmsFileQueue
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	Reads a list of files whole, in order, keeping up
+	            to a given number of them (the queue depth) in
+	            flight at once, so the reads of the next files
+	            overlap the decoding of this one.  Meant for batch
+	            conversion of many small files, where time goes to
+	            open/read/close round trips rather than to the
+	            disk.
+
+	            On Linux the open, size, read and close of each
+	            file are io_uring requests, submitted and reaped in
+	            batches (raw system calls; liburing is not needed).
+	            Where io_uring is missing or not allowed (old
+	            kernel, seccomp, kernel.io_uring_disabled), each
+	            file is read when it is asked for.
+
+	            next() hands back the files in list order; data()
+	            is the file's bytes as stored (still gzip'd), to
+	            give to MrmsSource::open(buf, len, name).  The
+	            bytes stay valid until the next call to next or
+	            close.  One buffer is kept per queue slot and
+	            reused, so memory is the queue depth times the
+	            largest file.
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+//io_uring state (see MrmsFileQueue.cc)
+struct MrmsFileRing;
+
+
+class MrmsFileQueue
+{
+  public:
+
+    //default constructor
+    MrmsFileQueue();
+
+    //destructor
+    ~MrmsFileQueue();
+
+    //non-copyable
+    MrmsFileQueue(const MrmsFileQueue& queue) = delete;
+    MrmsFileQueue& operator= (const MrmsFileQueue& queue) = delete;
+
+
+    //public methods
+    int open(const vector<string> &vfnames, int depth);
+    int next();
+    void close();
+
+    //current file: name, and its bytes
+    const string& fileName() const { return fileText; }
+    const unsigned char* data() const;
+    size_t size() const;
+
+    //true if reads go through io_uring
+    bool asynchronous() const { return (ring != 0); }
+
+    //why the last open or next failed
+    const string& errorMessage() const { return errorText; }
+
+
+  private:
+
+    //one file being read
+    struct Slot
+    {
+      size_t file;                 //index in files
+      int fd;
+      size_t size;                 //bytes in the file
+      size_t done;                 //bytes read so far
+      int waiting;                 //requests not yet completed
+      int status;                  //0 = reading, 1 = read, -1 = failed
+      string error;
+      vector<unsigned char> bytes;
+    };
+
+    //0 = synchronous reads
+    MrmsFileRing *ring;
+
+    vector<string> files;
+    vector<Slot> slots;
+    size_t nextFile;               //next file to hand out
+    size_t nextStart;              //next file to start reading
+    int current;                   //slot handed out last (-1 = none)
+
+    string fileText;
+    string errorText;
+
+    int openRing(int depth);
+    void closeRing();
+    void start(size_t file);
+    void complete(unsigned long long user_data, int result);
+    int submit(int wait_for);
+    void finish(Slot &slot, int status, const string &error);
+    int readFile(Slot &slot);
+
+};
+//end class MrmsFileQueue
+
+#endif
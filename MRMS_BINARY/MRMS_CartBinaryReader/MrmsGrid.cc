@@ -0,0 +1,1777 @@
+#include <stdio.h>
+#include <string.h>
+#include <ctime>
+#include <cmath>
+#include <sstream>
+#include <stdint.h>
+#include <thread>
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "MrmsGrid.h"
+#include "mrms_binary_reader.h"
+#include "mrms_inflate.h"
+#include "MrmsGzIndex.h"
+
+using namespace std;
+
+
+// C O N S T A N T S
+
+//Bytes requested by the first header read.  Covers a header with
+//up to ~1000 levels and radars combined; bigger headers take a
+//second read.
+static const size_t HEADER_READ_BYTES = 4096;
+
+
+
+// F U N C T I O N S
+
+/*------------------------------------------------------------------
+
+	Function:	header_bytes
+
+	Purpose:	Size in bytes of a header with nz levels and
+	            nradars radars
+
+------------------------------------------------------------------*/
+
+static size_t header_bytes(int nz, int nradars)
+{
+    return 162 + 4*(size_t)nz + 4*(size_t)nradars;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	get_int
+
+	Purpose:	Get a 4-byte int at a byte offset in a buffer,
+	            byte swapping if requested
+
+------------------------------------------------------------------*/
+
+static int get_int(const unsigned char *buf, size_t offset, int swap_flag)
+{
+    int value;
+    memcpy(&value, buf+offset, sizeof(int));
+
+    if(swap_flag == 1) byteswap(value);
+
+    return value;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	parse_header
+
+	Purpose:	Parse the header in buf with the given byte swap,
+	            reading more of the source into buf if the header
+	            needs it and the source can hold it.  The sizes
+	            the header declares must match the source, or with
+	            exact_size = true match it exactly (gzip ISIZE
+	            included).
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+static int parse_header(MrmsSource &source, int swap_flag, bool exact_size,
+                        MrmsHeader &hdr, vector<unsigned char> &buf)
+{
+    size_t needed = 0;
+    int status = 0;
+
+    while( (status = hdr.parse(buf.data(), buf.size(), swap_flag, needed)) == 0 )
+    {
+      //header continues past what was read.  Stop if the file
+      //cannot hold it or it simply isn't there
+      if( (buf.size() < HEADER_READ_BYTES) || !source.canHold(needed) )
+        return -1;
+
+      size_t have = buf.size();
+      buf.resize(needed);
+
+      long num_read = source.read(&buf[have], needed-have);
+      if( (num_read < 0) || ((size_t)num_read != needed-have) )
+      {
+        buf.resize(have + ((num_read > 0) ? num_read : 0));
+        return -1;
+      }
+    }
+
+    if(status < 0) return -1;
+    if( exact_size ? !source.matchesExactly(hdr.fileBytes())
+                   : !source.matches(hdr.fileBytes()) ) return -1;
+
+    hdr.swapFlag = swap_flag;
+
+    return 1;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	read_header
+
+	Purpose:	Read and parse the header of an open source, and
+	            check the sizes it declares against the source.
+	            The header is read in one buffered read (two if
+	            it is unusually large).
+
+	            With swap_flag = MRMS_SWAP_AUTO both byte orders
+	            are tried on the same header bytes, starting with
+	            the one cached for the source's feed, and the
+	            first that gives a plausible header wins.  A first
+	            pass asks for an exact size match (gzip ISIZE); the
+	            second accepts an advisory one, so multi-member
+	            gzip files are still read.  No data is decompressed
+	            for the wrong guess.
+
+	Output:		hdr = parsed header
+	            buf = bytes read; may run past the header into
+	                  the data array
+	            error = what went wrong, on failure
+	            int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+static int read_header(MrmsSource &source, int swap_flag,
+                       MrmsByteOrderCache *byte_orders,
+                       MrmsHeader &hdr, vector<unsigned char> &buf,
+                       string &error)
+{
+    const char *vfname = source.name().c_str();
+
+    buf.resize(HEADER_READ_BYTES);
+    long num_read = source.read(buf.data(), HEADER_READ_BYTES);
+    if(num_read < 0) num_read = 0;
+    buf.resize(num_read);
+
+
+    //Byte swap given by the caller
+    if(swap_flag != MRMS_SWAP_AUTO)
+    {
+      if(parse_header(source, swap_flag, false, hdr, buf) < 0)
+      {
+        error = string("Bad or truncated header in ") + vfname;
+        return -1;
+      }
+
+      return 1;
+    }
+
+
+    //Detect byte swap
+    int first_guess = 0;
+    if(byte_orders != 0) first_guess = byte_orders->lookup(vfname);
+    if(first_guess == MRMS_SWAP_AUTO) first_guess = 0;
+
+    for(int guess = 0; guess < 4; guess++)
+    {
+      int try_swap = ((guess % 2) == 0) ? first_guess : 1-first_guess;
+      bool exact_size = (guess < 2);
+
+      if( (parse_header(source, try_swap, exact_size, hdr, buf) > 0) &&
+          hdr.plausible() )
+      {
+        if(byte_orders != 0) byte_orders->remember(vfname, try_swap);
+        return 1;
+      }
+    }
+
+    error = string("Header of ") + vfname + " is not valid in either byte "
+          + "order. Bad or truncated file?";
+
+    return -1;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	allocation_error
+
+	Purpose:	Message for a data array that could not be
+	            allocated (a corrupt header on input whose size
+	            cannot be checked may ask for far too much)
+
+------------------------------------------------------------------*/
+
+static string allocation_error(size_t num_bytes, int nx, int ny, int nz)
+{
+    ostringstream message;
+    message<<"Cannot allocate "<<num_bytes<<" bytes for "<<nx<<" x "
+           <<ny<<" x "<<nz;
+
+    return message.str();
+}
+
+
+
+/*****************************/
+/*****************************/
+/** C O N S T R U C T O R S **/
+/*****************************/
+
+//MrmsByteOrderCache default constructor
+MrmsByteOrderCache::MrmsByteOrderCache() { }
+
+
+//MrmsHeader default constructor
+MrmsHeader::MrmsHeader()
+{
+    clear();
+}
+
+
+//default constructor
+MrmsGrid::MrmsGrid()
+{
+    values = 0;
+    numValues = 0;
+    storage = 0;
+    pool = 0;
+    inflater = mrms_inflate_default();
+    numThreads = (int)thread::hardware_concurrency();
+    if(numThreads < 1) numThreads = 1;
+    mapFiles = true;
+    mapping = 0;
+    mappingBytes = 0;
+    levelStart = levelCount = 0;
+    rowStart = rowCount = 0;
+}
+
+
+//move constructor
+MrmsGrid::MrmsGrid(MrmsGrid&& grid)
+{
+    hdr = std::move(grid.hdr);
+    values = grid.values;
+    numValues = grid.numValues;
+    storage = grid.storage;
+    pool = grid.pool;
+    inflater = grid.inflater;
+    numThreads = grid.numThreads;
+    mapFiles = grid.mapFiles;
+    mapping = grid.mapping;
+    mappingBytes = grid.mappingBytes;
+    levelStart = grid.levelStart;
+    levelCount = grid.levelCount;
+    rowStart = grid.rowStart;
+    rowCount = grid.rowCount;
+    errorText = std::move(grid.errorText);
+    warningText = std::move(grid.warningText);
+
+    grid.storage = 0;
+    grid.mapping = 0;
+    grid.clear();
+}
+
+
+//deconstructor
+MrmsGrid::~MrmsGrid()
+{
+    clear();
+}
+
+
+//MrmsSlabReader default constructor
+MrmsSlabReader::MrmsSlabReader()
+{
+    source = 0;
+    leftoverUsed = 0;
+    fileNx = fileNy = 0;
+    cropRow = cropCol = 0;
+    dataPos = 0;
+    slab = 0;
+    slabCapacity = 0;
+    numValues = 0;
+    pool = 0;
+    levelNum = -1;
+    rowStart = rowCount = 0;
+    nextLevel = nextRow = 0;
+}
+
+
+//MrmsSlabReader deconstructor
+MrmsSlabReader::~MrmsSlabReader()
+{
+    close();
+    freeSlab();
+}
+
+/************************************/
+/** E N D  C O N S T R U C T O R S **/
+/************************************/
+/************************************/
+
+
+
+/********************************/
+/********************************/
+/** P U B L I C  M E T H O D S **/
+/********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsHeader::numValues
+
+	Purpose:	Returns number of values in the data array
+	            (nx*ny*nz)
+
+------------------------------------------------------------------*/
+
+size_t MrmsHeader::numValues() const
+{
+    if( (nx < 1) || (ny < 1) || (nz < 1) ) return 0;
+
+    return (size_t)nx * (size_t)ny * (size_t)nz;
+
+}//end public method MrmsHeader::numValues
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsHeader::headerBytes
+
+	Purpose:	Returns size of the header in bytes, which is
+	            also the byte offset of the data array
+
+------------------------------------------------------------------*/
+
+size_t MrmsHeader::headerBytes() const
+{
+    return header_bytes(nz, nradars);
+
+}//end public method MrmsHeader::headerBytes
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsHeader::fileBytes
+
+	Purpose:	Returns size of the (uncompressed) file in bytes
+	            as declared by the header
+
+------------------------------------------------------------------*/
+
+size_t MrmsHeader::fileBytes() const
+{
+    return headerBytes() + numValues()*sizeof(short int);
+
+}//end public method MrmsHeader::fileBytes
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsHeader::probe
+
+	Purpose:	Read only the header of a MRMS Cartesian binary
+	            file.  The data array is never decompressed or
+	            allocated.  The sizes declared by the header are
+	            checked against the size of the file, so
+	            truncated or corrupt files fail here.
+
+	Input:		vfname = input file name and path
+
+	            swap_flag = flag (= 0 or 1) indicating if values
+	                        read from the file should be byte
+	                        swapped, or MRMS_SWAP_AUTO to detect
+
+	            byte_orders = optional cache of the byte swap
+	                        detected for each directory
+
+	Output:		error = optional; why the probe failed
+	            int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsHeader::probe(const char *vfname, int swap_flag,
+                      MrmsByteOrderCache *byte_orders, string *error)
+{
+    MrmsSource source;
+
+    if(source.open(vfname) < 0)
+    {
+      clear();
+      if(error != 0) *error = string("Could not open ") + vfname;
+      return -1;
+    }
+
+    return probe(source, swap_flag, byte_orders, error);
+
+}//end public method MrmsHeader::probe
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsHeader::probe (source)
+
+	Purpose:	As above, for a file given as an open source
+	            (buffer, file descriptor or callback).  Only the
+	            header bytes are taken from the source.
+
+------------------------------------------------------------------*/
+
+int MrmsHeader::probe(MrmsSource &source, int swap_flag,
+                      MrmsByteOrderCache *byte_orders, string *error)
+{
+    clear();
+
+    string probe_error;
+    if(error == 0) error = &probe_error;
+
+    if( !source.isOpen() )
+    {
+      *error = "No source open";
+      return -1;
+    }
+
+    vector<unsigned char> buf;
+    int status = read_header(source, swap_flag, byte_orders,
+                             *this, buf, *error);
+
+    if(status < 0) clear();
+
+    return status;
+
+}//end public method MrmsHeader::probe (source)
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsHeader::plausible
+
+	Purpose:	Returns true if the parsed header looks like a
+	            real MRMS file.  Used to tell the byte order: read
+	            in the wrong order, the date fields and sizes come
+	            out as huge or negative numbers.
+
+------------------------------------------------------------------*/
+
+bool MrmsHeader::plausible() const
+{
+    if( (year < 1970) || (year > 2200) ) return false;
+    if( (month < 1) || (month > 12) ) return false;
+    if( (day < 1) || (day > 31) ) return false;
+    if( (hour < 0) || (hour > 23) ) return false;
+    if( (minute < 0) || (minute > 59) ) return false;
+    if( (second < 0) || (second > 60) ) return false;
+
+    if( (nx < 1) || (ny < 1) || (nz < 1) || (nradars < 0) ) return false;
+    if(varScale == 0) return false;
+
+    return true;
+
+}//end public method MrmsHeader::plausible
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsByteOrderCache::lookup
+
+	Purpose:	Returns the byte swap last detected for files in
+	            the same directory as vfname, or MRMS_SWAP_AUTO if
+	            none yet
+
+------------------------------------------------------------------*/
+
+int MrmsByteOrderCache::lookup(const char *vfname)
+{
+    string dir = directoryOf(vfname);
+    lock_guard<mutex> lock(guard);
+
+    map<string, int>::const_iterator it = swapByDir.find(dir);
+    if(it == swapByDir.end()) return MRMS_SWAP_AUTO;
+
+    return it->second;
+
+}//end public method MrmsByteOrderCache::lookup
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsByteOrderCache::remember
+
+	Purpose:	Store the byte swap detected for vfname's
+	            directory
+
+------------------------------------------------------------------*/
+
+void MrmsByteOrderCache::remember(const char *vfname, int swap_flag)
+{
+    string dir = directoryOf(vfname);
+    lock_guard<mutex> lock(guard);
+
+    swapByDir[dir] = swap_flag;
+
+}//end public method MrmsByteOrderCache::remember
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsHeader::parse
+
+	Purpose:	Parse header fields from a buffer holding the
+	            start of a MRMS Cartesian binary file.  Byte
+	            positions (1-based) are noted next to each field.
+
+	Input:		buf, len = bytes from the start of the file
+
+	            swap_flag = flag (= 0 or 1) indicating if values
+	                        should be byte swapped
+
+	Output:		needed = number of bytes the header needs, so
+	                     far as can be told from buf
+
+	            int = header size in bytes when complete,
+	                  0 when buf is too short (see needed),
+	                  -1 when the header is not valid
+
+------------------------------------------------------------------*/
+
+int MrmsHeader::parse(const unsigned char *buf, size_t len, int swap_flag,
+                      size_t &needed)
+{
+    //fixed part, up to and including dxy_scale
+    needed = 80;
+    if(len < needed) return 0;
+
+    //reading time
+    year   = get_int(buf, 0, swap_flag);   // 1-4
+    month  = get_int(buf, 4, swap_flag);   // 5-8
+    day    = get_int(buf, 8, swap_flag);   // 9-12
+    hour   = get_int(buf, 12, swap_flag);  // 13-16
+    minute = get_int(buf, 16, swap_flag);  // 17-20
+    second = get_int(buf, 20, swap_flag);  // 21-24
+
+    //Compute epoch seconds (constant time, no time zone or static
+    //state).  Nonsense months (e.g. the wrong byte order) give 0
+    epochSeconds = 0;
+    if( (month >= 1) && (month <= 12) )
+      epochSeconds = days_from_civil(year, month, day)*86400L
+                   + hour*3600L + minute*60L + second;
+
+
+    //read dimensions
+    nx = get_int(buf, 24, swap_flag);  // 25-28
+    ny = get_int(buf, 28, swap_flag);  // 29-32
+    nz = get_int(buf, 32, swap_flag);  // 33-36
+    if( (nx < 1) || (ny < 1) || (nz < 1) ) return -1;
+    if( (size_t)nx*(size_t)ny > SIZE_MAX/(2*(size_t)nz) ) return -1;
+
+    //37-40 deprecated value (map projection type)
+
+    //read map scale factor
+    mapScale = get_int(buf, 40, swap_flag);  // 41-44
+    if(mapScale == 0) return -1;
+
+    //45-56 deprecated values (trulat1, trulat2, trulon)
+
+    //read nw lat/lon coordinates
+    nwLon = (float)get_int(buf, 56, swap_flag)/(float)mapScale;  // 57-60
+    nwLat = (float)get_int(buf, 60, swap_flag)/(float)mapScale;  // 61-64
+
+    //65-68 deprecated value (xy_scale)
+
+    //read dx and dy, and their scaling factor
+    dx = (float)get_int(buf, 68, swap_flag);  // 69-72
+    dy = (float)get_int(buf, 72, swap_flag);  // 73-76
+
+    int dxy_scale = get_int(buf, 76, swap_flag);  // 77-80
+    if(dxy_scale == 0) return -1;
+
+    dx = dx/float(dxy_scale);
+    dy = dy/float(dxy_scale);
+
+
+    //heights through number of radars
+    needed = header_bytes(nz, 0);
+    if(len < needed) return 0;
+
+    //read heights
+    zhgt.resize(nz);
+    for(int k = 0; k < nz; k++)  // 81- [80+nz*4]  (let [80+nz*4] = X)
+      zhgt[k] = (float)get_int(buf, 80+4*(size_t)k, swap_flag);
+
+    size_t X = 80 + 4*(size_t)nz;
+
+    //read z scale and unscale heights, if needed
+    int z_scale = get_int(buf, X, swap_flag);  // [X+1] - [X+4]
+
+    if( (z_scale != 1) && (z_scale != 0) )
+    {
+      for(int k = 0; k < nz; k++) zhgt[k] /= (float)z_scale;
+    }
+
+    //[X+5] - [X+44] junk (place holders for future use)
+
+    //read variable name
+    char temp_varname[20];
+    memcpy(temp_varname, buf+X+44, 20);  // [X+45] - [X+64]
+    temp_varname[19] = '\0';
+    varName = temp_varname;
+
+    //read variable unit
+    char temp_varunit[6];
+    memcpy(temp_varunit, buf+X+64, 6);  // [X+65] - [X+70]
+    temp_varunit[5] = '\0';
+    varUnit = temp_varunit;
+
+    //read variable scaling factor and missing flag
+    varScale = get_int(buf, X+70, swap_flag);    // [X+71] - [X+74]
+    missingVal = get_int(buf, X+74, swap_flag);  // [X+75] - [X+78]
+
+    //read number of radars affecting this product
+    nradars = get_int(buf, X+78, swap_flag);  // [X+79] - [X+82]
+    if(nradars < 0) return -1;
+
+
+    //names of radars
+    needed = header_bytes(nz, nradars);
+    if(len < needed) return 0;
+
+    char temp_radarnam[5];
+    radarNames.clear();
+
+    for(int i = 0; i < nradars; i++)  // [X+83] - [X+82+nradars*4]
+    {
+      memcpy(temp_radarnam, buf+X+82+4*(size_t)i, 4);
+      temp_radarnam[4] = '\0';
+
+      radarNames.push_back(temp_radarnam);
+    }
+
+    return (int)needed;
+
+}//end public method MrmsHeader::parse
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsHeader::crop
+
+	Purpose:	Shrink the grid to the cells whose centers lie in
+	            a lat/lon box, moving the NW corner and nx/ny to
+	            match.  Cells within 1/1000 of a cell of the box
+	            edge count as inside.
+
+	Input:		south, north = latitude bounds (degrees)
+	            west, east = longitude bounds (degrees)
+
+	Output:		first_row, first_col = where the cropped grid
+	                starts in the old one (row 0 = southernmost row,
+	                as stored in the file)
+	            int indicating success (1) or failure (-1, box
+	                misses the grid; header unchanged)
+
+------------------------------------------------------------------*/
+
+int MrmsHeader::crop(float south, float north, float west, float east,
+                     int &first_row, int &first_col)
+{
+    if( (nx < 1) || (ny < 1) || (dx <= 0) || (dy <= 0) ||
+        (south > north) || (west > east) ) return -1;
+
+    const double edge = 1.0e-3;
+
+    //columns counted west to east, rows north to south
+    double col_w = ceil( (west - nwLon)/(double)dx - edge );
+    double col_e = floor( (east - nwLon)/(double)dx + edge );
+    double row_n = ceil( (nwLat - north)/(double)dy - edge );
+    double row_s = floor( (nwLat - south)/(double)dy + edge );
+
+    if(col_w < 0) col_w = 0;
+    if(col_e > nx-1) col_e = nx-1;
+    if(row_n < 0) row_n = 0;
+    if(row_s > ny-1) row_s = ny-1;
+
+    if( (col_w > col_e) || (row_n > row_s) ) return -1;
+
+    first_row = ny - 1 - (int)row_s;
+    first_col = (int)col_w;
+
+    nwLat = nwLat - dy*(float)row_n;
+    nwLon = nwLon + dx*(float)col_w;
+    nx = (int)(col_e - col_w) + 1;
+    ny = (int)(row_s - row_n) + 1;
+
+    return 1;
+
+}//end public method MrmsHeader::crop
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsHeader::clear
+
+	Purpose:	Clears object to original (blank) state
+
+------------------------------------------------------------------*/
+
+void MrmsHeader::clear()
+{
+    year = month = day = 0;
+    hour = minute = second = 0;
+    epochSeconds = 0;
+
+    nx = ny = nz = 0;
+
+    mapScale = 0;
+    nwLon = nwLat = 0.0;
+    dx = dy = 0.0;
+    zhgt.clear();
+
+    varName.clear();
+    varUnit.clear();
+    varScale = 1;
+    missingVal = 0;
+
+    nradars = 0;
+    radarNames.clear();
+
+    swapFlag = 0;
+
+}//end public method MrmsHeader::clear
+
+
+/*------------------------------------------------------------------
+
+	Method:		read
+
+	Purpose:	Read a MRMS Cartesian binary file and store its
+	            header info and data.  Any previously held grid
+	            is released first.
+
+	Input:		vfname = input file name and path
+
+	            swap_flag = flag (= 0 or 1) indicating if values
+	                        read from the file should be byte
+	                        swapped, or MRMS_SWAP_AUTO to detect
+
+	            byte_orders = optional cache of the byte swap
+	                        detected for each directory
+
+	Output:		int indicating success (1) or failure (-1; see
+	            errorMessage)
+
+------------------------------------------------------------------*/
+
+int MrmsGrid::read(const char *vfname, int swap_flag,
+                   MrmsByteOrderCache *byte_orders)
+{
+    MrmsSource source;
+
+    if(source.open(vfname) < 0)
+    {
+      clear();
+      errorText = string("Could not open ") + vfname;
+      warningText.clear();
+      return -1;
+    }
+
+    return read(source, swap_flag, byte_orders);
+
+}//end public method MrmsGrid::read
+
+
+/*------------------------------------------------------------------
+
+	Method:		read (source)
+
+	Purpose:	As above, for a file given as an open source
+	            (buffer, file descriptor or callback).  The source
+	            is read to the end of the data array and left
+	            open for the caller to close.
+
+------------------------------------------------------------------*/
+
+int MrmsGrid::read(MrmsSource &source, int swap_flag,
+                   MrmsByteOrderCache *byte_orders)
+{
+    clear();
+    errorText.clear();
+    warningText.clear();
+
+    if( !source.isOpen() )
+    {
+      errorText = "No source open";
+      return -1;
+    }
+
+    const char *vfname = source.name().c_str();
+
+
+    /*** 1. Read header and data ***/
+
+    //the header is read (and checked against the source size) in
+    //one block; any data bytes that came along with it are kept
+    vector<unsigned char> buf;
+    int status = read_header(source, swap_flag, byte_orders,
+                             hdr, buf, errorText);
+
+    //parallel inflate from the random-access index, if there is one
+    int indexed = 0;
+    if( (status > 0) && (source.path() != 0) && source.gzip() && (numThreads > 1) )
+    {
+      indexed = inflateIndexed(vfname);
+      if(indexed < 0)
+        warningText = string("Parallel inflate of ") + vfname
+                    + " did not verify. Read it serially.";
+    }
+
+    //map files that are not gzip'd (falls back to reading on failure)
+    int mapped_file = 0;
+    if( (status > 0) && (source.path() != 0) && !source.gzip() && mapFiles )
+      mapped_file = mapFile(vfname);
+
+    if( (status > 0) && ( (indexed > 0) || (mapped_file > 0) ) )
+    {
+      //done
+    }
+    else if( (status > 0) && source.gzip() && (inflater == MRMS_INFLATE_LIBDEFLATE) &&
+             ( (source.path() != 0) || (source.memory() != 0) ) )
+    {
+      //one-shot inflate of the whole file, sized from the header
+      //(errorText is already set if the output could not be allocated)
+      status = inflateFile(source);
+      if( (status < 0) && errorText.empty() )
+        errorText = string("Corrupt or truncated data in ") + vfname;
+    }
+    else if(status > 0)
+    {
+      size_t hdr_bytes = hdr.headerBytes();
+
+      status = readData(source, hdr.swapFlag, buf.data() + hdr_bytes,
+                        buf.size() - hdr_bytes);
+      if( (status < 0) && errorText.empty() )
+        errorText = string("Truncated data array in ") + vfname;
+    }
+
+
+    /*** 2. Return ***/
+
+    if(status < 0) clear();
+    else
+    {
+      levelCount = hdr.nz;
+      rowCount = hdr.ny;
+    }
+
+    return status;
+
+}//end public method MrmsGrid::read (source)
+
+
+/*------------------------------------------------------------------
+
+	Method:		readLevels
+
+	Purpose:	Read the header and levels
+	            [first_level, first_level+num_levels) of a MRMS
+	            Cartesian binary file.  data() then holds
+	            num_levels*ny*nx values, ordered as in the file.
+
+	Input:		see read
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsGrid::readLevels(const char *vfname, int swap_flag,
+                         int first_level, int num_levels,
+                         MrmsByteOrderCache *byte_orders)
+{
+    return readRegion(vfname, swap_flag, first_level, num_levels,
+                      0, -1, byte_orders);
+
+}//end public method MrmsGrid::readLevels
+
+
+/*------------------------------------------------------------------
+
+	Method:		readRows
+
+	Purpose:	Read the header and rows [first_row,
+	            first_row+num_rows) of one level.  Row 0 is the
+	            southernmost row.  data() then holds num_rows*nx
+	            values.
+
+	Input:		see read
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsGrid::readRows(const char *vfname, int swap_flag,
+                       int level, int first_row, int num_rows,
+                       MrmsByteOrderCache *byte_orders)
+{
+    return readRegion(vfname, swap_flag, level, 1,
+                      first_row, num_rows, byte_orders);
+
+}//end public method MrmsGrid::readRows
+
+
+/*------------------------------------------------------------------
+
+	Method:		release
+
+	Purpose:	Hands ownership of the data array to the caller,
+	            who must free it with delete [].  The header is
+	            kept.  Data mapped from a file or held in a buffer
+	            pool is copied.
+
+------------------------------------------------------------------*/
+
+short int* MrmsGrid::release()
+{
+    //mapped or pooled data is copied into an array the caller can free
+    if( (mapping != 0) || ((pool != 0) && (storage != 0)) )
+    {
+      short int *released = new short int[numValues];
+      memcpy(released, values, numValues*sizeof(short int));
+
+      clearData();
+      return released;
+    }
+
+    //data must start at the front of the allocation handed out
+    if( (values != 0) && (values != storage) )
+      memmove(storage, values, numValues*sizeof(short int));
+
+    short int *released = storage;
+
+    values = 0;
+    numValues = 0;
+    storage = 0;
+
+    return released;
+
+}//end public method MrmsGrid::release
+
+
+/*------------------------------------------------------------------
+
+	Method:		clear
+
+	Purpose:	Frees the data array and clears the header
+
+------------------------------------------------------------------*/
+
+void MrmsGrid::clear()
+{
+    clearData();
+
+    levelStart = levelCount = 0;
+    rowStart = rowCount = 0;
+    hdr.clear();
+
+}//end public method MrmsGrid::clear
+
+
+/*------------------------------------------------------------------
+
+	Method:		setInflateBackend
+
+	Purpose:	Choose how gzip'd files are inflated by read
+	            (MRMS_INFLATE_ZLIB or MRMS_INFLATE_LIBDEFLATE).
+	            Backends not compiled in fall back to zlib.
+
+------------------------------------------------------------------*/
+
+void MrmsGrid::setInflateBackend(int backend)
+{
+    if( mrms_inflate_available(backend) ) inflater = backend;
+    else inflater = MRMS_INFLATE_ZLIB;
+
+}//end public method MrmsGrid::setInflateBackend
+
+
+/*------------------------------------------------------------------
+
+	Method:		setThreads
+
+	Purpose:	Number of threads read may use to inflate a file
+	            that has a random-access index.  1 = always serial.
+
+------------------------------------------------------------------*/
+
+void MrmsGrid::setThreads(int num_threads)
+{
+    numThreads = (num_threads > 0) ? num_threads : 1;
+
+}//end public method MrmsGrid::setThreads
+
+
+/*------------------------------------------------------------------
+
+	Method:		setBufferPool
+
+	Purpose:	Take data arrays from a buffer pool (0 = new []).
+	            Any data held is freed first.
+
+------------------------------------------------------------------*/
+
+void MrmsGrid::setBufferPool(MrmsBufferPool *buffer_pool)
+{
+    clearData();
+    pool = buffer_pool;
+
+}//end public method MrmsGrid::setBufferPool
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsSlabReader::open
+
+	Purpose:	Open a MRMS Cartesian binary file and read its
+	            header.  The data array is left to next().  Any
+	            file already open is closed first.
+
+	Input:		see MrmsGrid::read
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsSlabReader::open(const char *vfname, int swap_flag,
+                         MrmsByteOrderCache *byte_orders)
+{
+    close();
+    errorText.clear();
+
+    if(fileSource.open(vfname) < 0)
+    {
+      errorText = string("Could not open ") + vfname;
+      return -1;
+    }
+
+    return openSource(fileSource, swap_flag, byte_orders);
+
+}//end public method MrmsSlabReader::open
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsSlabReader::open (source)
+
+	Purpose:	As above, for a file given as an open source
+	            (buffer, file descriptor or callback).  The source
+	            must stay open until close; it is not closed here.
+
+------------------------------------------------------------------*/
+
+int MrmsSlabReader::open(MrmsSource &input, int swap_flag,
+                         MrmsByteOrderCache *byte_orders)
+{
+    close();
+    errorText.clear();
+
+    if( !input.isOpen() )
+    {
+      errorText = "No source open";
+      return -1;
+    }
+
+    return openSource(input, swap_flag, byte_orders);
+
+}//end public method MrmsSlabReader::open (source)
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsSlabReader::crop
+
+	Purpose:	Read only the cells of each level inside a lat/lon
+	            box (see MrmsHeader::crop).  header() then
+	            describes the cropped grid.  Must be called after
+	            open and before the first next.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsSlabReader::crop(float south, float north, float west, float east)
+{
+    if( (source == 0) || (dataPos > 0) || (levelNum >= 0) )
+    {
+      errorText = "crop must follow open and come before next";
+      return -1;
+    }
+
+    if(hdr.crop(south, north, west, east, cropRow, cropCol) < 0)
+    {
+      ostringstream message;
+      message<<"Box "<<south<<" to "<<north<<" N, "<<west<<" to "
+             <<east<<" E is outside the grid of "<<fileName;
+      errorText = message.str();
+      return -1;
+    }
+
+    return 1;
+
+}//end public method MrmsSlabReader::crop
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsSlabReader::next
+
+	Purpose:	Read the next slab of the data array: the next
+	            num_rows rows of the current level, or the rest of
+	            the level if num_rows < 1.  A slab never spans two
+	            levels.  Levels come lowest first and rows south
+	            to north, as in the file.
+
+	Output:		data() holds numRows()*nx values of level()
+	            int indicating a slab was read (1), the end of the
+	            data array (0), or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsSlabReader::next(int num_rows)
+{
+    if(source == 0)
+    {
+      if(errorText.empty()) errorText = "No file open";
+      return -1;
+    }
+    if(nextLevel >= hdr.nz) return 0;
+
+    int rows_left = hdr.ny - nextRow;
+    if( (num_rows < 1) || (num_rows > rows_left) ) num_rows = rows_left;
+
+    size_t num_read = (size_t)num_rows * (size_t)fileNx;
+    if(slabCapacity < num_read)
+    {
+      freeSlab();
+
+      if(pool != 0) slab = pool->acquireArray< short int >( num_read );
+      else slab = new (nothrow) short int[num_read];
+
+      if(slab == 0)
+      {
+        errorText = allocation_error(num_read*sizeof(short int), fileNx,
+                                     num_rows, 1);
+        close();
+        return -1;
+      }
+      slabCapacity = num_read;
+    }
+
+    numValues = (size_t)num_rows * (size_t)hdr.nx;
+
+
+    //skip to the first row wanted (rows outside a crop are inflated
+    //and dropped), then read whole rows
+    size_t wanted = ( ((size_t)nextLevel*fileNy + cropRow + nextRow) * fileNx )
+                  * sizeof(short int);
+
+    if( (readBytes(0, wanted - dataPos) < 0) ||
+        (readBytes(slab, num_read*sizeof(short int)) < 0) )
+    {
+      errorText = "Truncated data array in " + fileName;
+      close();
+      return -1;
+    }
+
+    //keep only the columns inside a crop
+    if(hdr.nx < fileNx)
+    {
+      short int *rows = slab;
+
+      for(int j = 0; j < num_rows; j++)
+        memmove(rows + (size_t)j*hdr.nx, rows + (size_t)j*fileNx + cropCol,
+                hdr.nx*sizeof(short int));
+    }
+
+    if(hdr.swapFlag == 1) byteswap(slab, numValues);
+
+
+    levelNum = nextLevel;
+    rowStart = nextRow;
+    rowCount = num_rows;
+
+    nextRow += num_rows;
+    if(nextRow >= hdr.ny)
+    {
+      nextRow = 0;
+      nextLevel++;
+    }
+
+    return 1;
+
+}//end public method MrmsSlabReader::next
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsSlabReader::close
+
+	Purpose:	Close the file (a caller's source is left open).
+	            The header is kept; the slab buffer is kept for
+	            reuse by the next open.
+
+------------------------------------------------------------------*/
+
+void MrmsSlabReader::close()
+{
+    fileSource.close();
+    source = 0;
+
+    leftover.clear();
+    leftoverUsed = 0;
+    cropRow = cropCol = 0;
+    dataPos = 0;
+    numValues = 0;
+    levelNum = -1;
+    rowStart = rowCount = 0;
+    nextLevel = nextRow = 0;
+
+}//end public method MrmsSlabReader::close
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsSlabReader::setBufferPool
+
+	Purpose:	Take the slab buffer from a buffer pool (0 = new
+	            []).  The current slab buffer is freed first.
+
+------------------------------------------------------------------*/
+
+void MrmsSlabReader::setBufferPool(MrmsBufferPool *buffer_pool)
+{
+    freeSlab();
+    pool = buffer_pool;
+
+}//end public method MrmsSlabReader::setBufferPool
+
+/***************************************/
+/** E N D  P U B L I C  M E T H O D S **/
+/***************************************/
+/***************************************/
+
+
+
+/**********************************/
+/**********************************/
+/** P R I V A T E  M E T H O D S **/
+/**********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		readData
+
+	Purpose:	Read the scaled data array that follows the header
+	            [X+83+nradars*4] - [X+82+nradars*4+num*2]
+
+	Input:		leftover = data bytes already read along with
+	                       the header
+
+------------------------------------------------------------------*/
+
+int MrmsGrid::readData(MrmsSource &source, int swap_flag,
+                       const unsigned char *leftover, size_t num_leftover)
+{
+    numValues = hdr.numValues();
+    values = storage = allocate(numValues, hdr.ny, hdr.nz);
+    if(storage == 0) return -1;
+
+    char *dest = reinterpret_cast< char * >( values );
+    size_t remaining = numValues*sizeof(short int);
+
+    if(num_leftover > remaining) num_leftover = remaining;
+    memcpy(dest, leftover, num_leftover);
+    dest += num_leftover;
+    remaining -= num_leftover;
+
+    if( source.readAll(dest, remaining) < 0 ) return -1;
+
+    if(swap_flag == 1) byteswap(values, numValues);
+
+    return 1;
+
+}//end private method MrmsGrid::readData
+
+
+/*------------------------------------------------------------------
+
+	Method:		inflateFile
+
+	Purpose:	Inflate the whole gzip'd file (header and data)
+	            in one call, from the named file or the buffer
+	            in memory.  The header has already been read
+	            and checked against the gzip trailer, so the
+	            output is sized exactly.  The header is an even
+	            number of bytes, so values points at the data
+	            inside the same allocation; nothing is copied.
+
+------------------------------------------------------------------*/
+
+int MrmsGrid::inflateFile(MrmsSource &source)
+{
+    size_t file_bytes = hdr.fileBytes();
+
+    storage = allocate(file_bytes/sizeof(short int), hdr.ny, hdr.nz);
+    if(storage == 0) return -1;
+
+    int status = (source.path() != 0)
+               ? mrms_gunzip_file(source.path(), storage, file_bytes)
+               : mrms_gunzip_buffer(source.memory(), source.memoryBytes(),
+                                    storage, file_bytes);
+    if(status < 0) return -1;
+
+    numValues = hdr.numValues();
+    values = storage + hdr.headerBytes()/sizeof(short int);
+
+    if(hdr.swapFlag == 1) byteswap(values, numValues);
+
+    return 1;
+
+}//end private method MrmsGrid::inflateFile
+
+
+/*------------------------------------------------------------------
+
+	Method:		inflateIndexed
+
+	Purpose:	Inflate the whole file on numThreads threads using
+	            its random-access index (see MrmsGzIndex::inflateAll)
+
+	Output:		int = 1 on success, 0 if the file has no usable
+	                  index, -1 if the parallel inflate failed
+	                  (nothing is kept)
+
+------------------------------------------------------------------*/
+
+int MrmsGrid::inflateIndexed(const char *vfname)
+{
+    MrmsGzIndex index;
+    if( (index.load(vfname) < 0) || (index.numPoints() < 2) ) return 0;
+
+    size_t file_bytes = hdr.fileBytes();
+
+    //out of memory: leave it to the serial read to report
+    storage = allocate(file_bytes/sizeof(short int), hdr.ny, hdr.nz);
+    if(storage == 0)
+    {
+      errorText.clear();
+      return 0;
+    }
+
+    if( index.inflateAll(storage, file_bytes, numThreads) < 0 )
+    {
+      clearData();
+      return -1;
+    }
+
+    numValues = hdr.numValues();
+    values = storage + hdr.headerBytes()/sizeof(short int);
+
+    if(hdr.swapFlag == 1) byteswap(values, numValues);
+
+    return 1;
+
+}//end private method MrmsGrid::inflateIndexed
+
+
+/*------------------------------------------------------------------
+
+	Method:		mapFile
+
+	Purpose:	Map an uncompressed file so that values points
+	            at its data array in place.  The header is an even
+	            number of bytes, so the data is aligned for short
+	            int.  The mapping is private and copy-on-write;
+	            only a byte swap (or a caller writing to the data)
+	            copies pages.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsGrid::mapFile(const char *vfname)
+{
+    size_t file_bytes = hdr.fileBytes();
+
+    int fd = open(vfname, O_RDONLY);
+    if(fd < 0) return -1;
+
+    struct stat st;
+    if( (fstat(fd, &st) != 0) || ((size_t)st.st_size < file_bytes) )
+    {
+      close(fd);
+      return -1;
+    }
+
+    void *map = mmap(0, file_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(map == MAP_FAILED) return -1;
+
+    madvise(map, file_bytes, MADV_WILLNEED);
+
+    mapping = map;
+    mappingBytes = file_bytes;
+
+    numValues = hdr.numValues();
+    values = reinterpret_cast< short int * >(
+               static_cast< char * >( map ) + hdr.headerBytes() );
+
+    if(hdr.swapFlag == 1) byteswap(values, numValues);
+
+    return 1;
+
+}//end private method MrmsGrid::mapFile
+
+
+/*------------------------------------------------------------------
+
+	Method:		allocate
+
+	Purpose:	Allocate num_values shorts (hdr.nx x num_rows x
+	            num_levels of them, for the message) from the
+	            buffer pool, or with new [] if there is none
+
+	Output:		buffer, or 0 with errorText set if out of memory
+
+------------------------------------------------------------------*/
+
+short int* MrmsGrid::allocate(size_t num_values, int num_rows, int num_levels)
+{
+    short int *buf = (pool != 0) ? pool->acquireArray< short int >( num_values )
+                                 : new (nothrow) short int[num_values];
+
+    if(buf == 0)
+      errorText = allocation_error(num_values*sizeof(short int), hdr.nx,
+                                   num_rows, num_levels);
+
+    return buf;
+
+}//end private method MrmsGrid::allocate
+
+
+/*------------------------------------------------------------------
+
+	Method:		clearData
+
+	Purpose:	Free (or unmap) the data array; the header is kept
+
+------------------------------------------------------------------*/
+
+void MrmsGrid::clearData()
+{
+    if( (storage != 0) && (pool != 0) ) pool->release(storage);
+    else if(storage != 0) delete [] storage;
+
+    if(mapping != 0) munmap(mapping, mappingBytes);
+
+    values = 0;
+    numValues = 0;
+    storage = 0;
+    mapping = 0;
+    mappingBytes = 0;
+
+}//end private method MrmsGrid::clearData
+
+
+/*------------------------------------------------------------------
+
+	Method:		readRegion
+
+	Purpose:	Read the header and the same rows of a range of
+	            levels.  num_rows < 0 means all rows.  Each level's
+	            rows are one contiguous run of bytes in the file;
+	            each run is inflated from the nearest index
+	            checkpoint when there is a sidecar index, and
+	            otherwise by skipping forward in the stream.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsGrid::readRegion(const char *vfname, int swap_flag,
+                         int first_level, int num_levels,
+                         int first_row, int num_rows,
+                         MrmsByteOrderCache *byte_orders)
+{
+    clear();
+    errorText.clear();
+    warningText.clear();
+
+    MrmsSource source;
+
+    if(source.open(vfname) < 0)
+    {
+      errorText = string("Could not open ") + vfname;
+      return -1;
+    }
+
+    vector<unsigned char> buf;
+    int status = read_header(source, swap_flag, byte_orders,
+                             hdr, buf, errorText);
+
+    if(num_rows < 0) num_rows = hdr.ny - first_row;
+
+    if( (status > 0) &&
+        ( (first_level < 0) || (num_levels < 1) || (first_level > hdr.nz - num_levels) ||
+          (first_row < 0) || (num_rows < 1) || (first_row > hdr.ny - num_rows) ) )
+    {
+      errorText = string("Levels/rows requested are outside the grid of ")
+                + vfname;
+      status = -1;
+    }
+
+
+    //Read each level's run of rows
+    MrmsGzIndex index;
+    bool indexed = false;
+
+    if(status > 0)
+    {
+      indexed = source.gzip() && (index.load(vfname) > 0);
+
+      numValues = (size_t)num_levels * (size_t)num_rows * (size_t)hdr.nx;
+      values = storage = allocate(numValues, num_rows, num_levels);
+      if(storage == 0) status = -1;
+    }
+
+    size_t run_bytes = (size_t)num_rows * (size_t)hdr.nx * sizeof(short int);
+    char *dest = reinterpret_cast< char * >( values );
+
+    //bytes of the stream read so far (the header read may have
+    //taken some of the data array with it)
+    size_t stream_pos = buf.size();
+
+    for(int k = first_level; (status > 0) && (k < first_level+num_levels); k++)
+    {
+      size_t offset = hdr.headerBytes()
+                    + ( ((size_t)k*hdr.ny + first_row) * hdr.nx )*sizeof(short int);
+
+      if(indexed)
+        status = index.extract(offset, dest, run_bytes);
+      else
+      {
+        //part of the run already in buf, then the rest from the
+        //stream
+        size_t from_buf = 0;
+        if(offset < buf.size())
+        {
+          from_buf = buf.size() - offset;
+          if(from_buf > run_bytes) from_buf = run_bytes;
+          memcpy(dest, buf.data() + offset, from_buf);
+        }
+
+        size_t run_start = offset + from_buf;
+        size_t run_left = run_bytes - from_buf;
+
+        if( (run_left > 0) &&
+            ( (source.skip(run_start - stream_pos) < 0) ||
+              (source.readAll(dest + from_buf, run_left) < 0) ) )
+          status = -1;
+
+        if(run_left > 0) stream_pos = run_start + run_left;
+      }
+
+      if(status < 0)
+        errorText = string("Corrupt or truncated data in ") + vfname;
+
+      dest += run_bytes;
+    }
+
+    source.close();
+
+    if(status < 0)
+    {
+      clear();
+      return -1;
+    }
+
+    if(hdr.swapFlag == 1) byteswap(values, numValues);
+
+    levelStart = first_level;
+    levelCount = num_levels;
+    rowStart = first_row;
+    rowCount = num_rows;
+
+    return 1;
+
+}//end private method MrmsGrid::readRegion
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsSlabReader::openSource
+
+	Purpose:	Read the header from an open source and get ready
+	            to hand out its data array
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsSlabReader::openSource(MrmsSource &input, int swap_flag,
+                               MrmsByteOrderCache *byte_orders)
+{
+    fileName = input.name();
+
+    if( read_header(input, swap_flag, byte_orders,
+                    hdr, leftover, errorText) < 0 )
+    {
+      close();
+      return -1;
+    }
+
+    source = &input;
+
+    //data bytes that came in with the header are handed out first
+    leftoverUsed = hdr.headerBytes();
+    if(leftoverUsed > leftover.size()) leftoverUsed = leftover.size();
+
+    fileNx = hdr.nx;
+    fileNy = hdr.ny;
+
+    return 1;
+
+}//end private method MrmsSlabReader::openSource
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsSlabReader::readBytes
+
+	Purpose:	Read the next num_bytes of the data array into
+	            dest, or skip them if dest is 0.  Bytes read along
+	            with the header are used first.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsSlabReader::readBytes(void *dest, size_t num_bytes)
+{
+    char *out = static_cast< char * >( dest );
+
+    size_t num_leftover = leftover.size() - leftoverUsed;
+    if(num_leftover > num_bytes) num_leftover = num_bytes;
+
+    if(out != 0)
+    {
+      memcpy(out, leftover.data() + leftoverUsed, num_leftover);
+      out += num_leftover;
+    }
+
+    leftoverUsed += num_leftover;
+    dataPos += num_leftover;
+    num_bytes -= num_leftover;
+
+    if(num_bytes == 0) return 1;
+
+    if(out != 0)
+    {
+      if( source->readAll(out, num_bytes) < 0 ) return -1;
+    }
+    else if( source->skip(num_bytes) < 0 ) return -1;
+
+    dataPos += num_bytes;
+
+    return 1;
+
+}//end private method MrmsSlabReader::readBytes
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsSlabReader::freeSlab
+
+	Purpose:	Free the slab buffer
+
+------------------------------------------------------------------*/
+
+void MrmsSlabReader::freeSlab()
+{
+    if( (slab != 0) && (pool != 0) ) pool->release(slab);
+    else if(slab != 0) delete [] slab;
+
+    slab = 0;
+    slabCapacity = 0;
+    numValues = 0;
+
+}//end private method MrmsSlabReader::freeSlab
+
+
+/*------------------------------------------------------------------
+
+	Method:		MrmsByteOrderCache::directoryOf
+
+	Purpose:	Directory part of a file path ("." if none)
+
+------------------------------------------------------------------*/
+
+string MrmsByteOrderCache::directoryOf(const char *vfname)
+{
+    string path = vfname;
+    size_t slash = path.rfind('/');
+
+    if(slash == string::npos) return ".";
+    if(slash == 0) return "/";
+
+    return path.substr(0, slash);
+
+}//end private method MrmsByteOrderCache::directoryOf
+
+/*****************************************/
+/** E N D  P R I V A T E  M E T H O D S **/
+/*****************************************/
+/*****************************************/
+
+
+
+/********************************************/
+/********************************************/
+/** O V E R L O A D E D  O P E R A T O R S **/
+/********************************************/
+
+MrmsGrid& MrmsGrid::operator= (MrmsGrid&& grid)
+{
+    if(this != &grid)
+    {
+      clear();
+
+      hdr = std::move(grid.hdr);
+      values = grid.values;
+      numValues = grid.numValues;
+      storage = grid.storage;
+      pool = grid.pool;
+      inflater = grid.inflater;
+      numThreads = grid.numThreads;
+      mapFiles = grid.mapFiles;
+      mapping = grid.mapping;
+      mappingBytes = grid.mappingBytes;
+      levelStart = grid.levelStart;
+      levelCount = grid.levelCount;
+      rowStart = grid.rowStart;
+      rowCount = grid.rowCount;
+      errorText = std::move(grid.errorText);
+      warningText = std::move(grid.warningText);
+
+      grid.storage = 0;
+      grid.mapping = 0;
+      grid.clear();
+    }
+
+    return *this;
+
+}//end move operator= method
+
+/***************************************************/
+/** E N D  O V E R L O A D E D  O P E R A T O R S **/
+/***************************************************/
+/***************************************************/
+
+//End Class MrmsGrid
@@ -0,0 +1,380 @@
+#ifndef MRMSGRID_H
+#define MRMSGRID_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <mutex>
+#include <cstddef>
+
+#include "MrmsBufferPool.h"
+#include "MrmsSource.h"
+
+using namespace std;
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	File:		MrmsGrid
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	MrmsHeader stores the header of a MRMS Cartesian
+	            binary file.  MrmsGrid owns a header and the
+	            (scaled) int16 data array read from the file.
+
+	            MrmsGrid is moveable but not copyable, so a grid
+	            can be handed between threads and processing
+	            stages without copying or leaking its data.  There
+	            is no fixed limit on the number of levels.
+
+	            MrmsHeader::probe reads only the header bytes,
+	            so a file can be triaged (name, time, grid)
+	            without decompressing or allocating its data.
+
+	            gzip'd files are inflated with the backend set by
+	            setInflateBackend (see mrms_inflate.h); by default
+	            the fastest one compiled in.  If the file has a
+	            random-access index (MrmsGzIndex sidecar), read
+	            inflates it on setThreads threads instead, falling
+	            back to a serial read if the result does not
+	            verify.
+
+	            Files that are not gzip'd are memory-mapped rather
+	            than read: data() then points into the page cache
+	            and nothing is copied.  The mapping is private, so
+	            writes through data() (including the byte swap, if
+	            needed) copy only the pages touched and never
+	            reach the file.  The file must not be truncated
+	            while the grid holds it.
+
+	            readLevels/readRows read only part of the data
+	            array: a range of levels, or a range of rows of
+	            one level.  If the file has a random-access index
+	            (MrmsGzIndex sidecar) inflating starts at the
+	            nearest checkpoint; otherwise the stream is
+	            inflated up to the wanted bytes and discarded.
+
+	            MrmsSlabReader streams the data array instead: each
+	            call to next() inflates one level (or a few rows of
+	            it) into a buffer that is reused for the next call,
+	            so a 3D cube of any depth is read in O(nx*ny)
+	            memory.  crop() limits it to a lat/lon box: rows
+	            outside the box are skipped as they are inflated,
+	            and only the columns inside are kept.
+
+	            Given a buffer pool (setBufferPool), both classes
+	            take their data buffers from it and give them back
+	            when done, instead of new/delete (see
+	            MrmsBufferPool.h).
+
+	            probe, read and MrmsSlabReader::open also take an
+	            MrmsSource, so a file can be decoded straight from
+	            a buffer in memory, an open file descriptor or a
+	            pull callback, with no copy on disk.  Only a named
+	            file can be memory-mapped or use a sidecar index;
+	            a gzip'd buffer is inflated in one call when
+	            libdeflate is the backend.
+
+	            Passing swap_flag = MRMS_SWAP_AUTO lets the reader
+	            work out the byte order from the header itself.
+	            MrmsByteOrderCache remembers the answer for each
+	            directory (feed), so later files there are checked
+	            in that order first.
+
+	            The readers keep no static state and print
+	            nothing: a failed call returns -1 and leaves the
+	            reason in errorMessage() (probe: its error
+	            argument).  Separate objects can be used from
+	            separate threads at once; an MrmsByteOrderCache or
+	            MrmsBufferPool can be shared between them.
+
+	            See MRMS_BINARY/docs/MRMS_Gridded_BinaryFormat.pdf
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+// C O N S T A N T S
+
+//swap_flag value asking the reader to detect the byte order
+static const int MRMS_SWAP_AUTO = -1;
+
+
+
+class MrmsByteOrderCache
+{
+  public:
+
+    //default constructor
+    MrmsByteOrderCache();
+
+    //public methods
+    int lookup(const char *vfname);
+    void remember(const char *vfname, int swap_flag);
+
+  private:
+
+    map<string, int> swapByDir;
+    mutex guard;
+
+    static string directoryOf(const char *vfname);
+
+};
+//end class MrmsByteOrderCache
+
+
+
+class MrmsHeader
+{
+  public:
+
+    //valid time
+    int year, month, day;
+    int hour, minute, second;
+    long epochSeconds;   //seconds since Jan. 1, 1970 00:00:00 UTC
+
+    //grid dimensions
+    int nx;   //number of columns
+    int ny;   //number of rows
+    int nz;   //number of vertical levels
+
+    //grid geometry
+    int mapScale;
+    float nwLon;   //longitude of NW grid cell (center of cell)
+    float nwLat;   //latitude of NW grid cell (center of cell)
+    float dx;      //size of grid cell (degrees longitude)
+    float dy;      //size of grid cell (degrees latitude)
+    vector<float> zhgt;   //height of vertical levels (nz entries)
+
+    //variable info
+    string varName;
+    string varUnit;
+    int varScale;     //value used to scale the variable data
+    int missingVal;   //value to indicate missing data
+
+    //radars used in product
+    int nradars;
+    vector<string> radarNames;
+
+    //byte swap that was applied when reading (0 or 1)
+    int swapFlag;
+
+
+    //default constructor
+    MrmsHeader();
+
+    //public methods
+    int probe(const char *vfname, int swap_flag,
+              MrmsByteOrderCache *byte_orders = 0, string *error = 0);
+    int probe(MrmsSource &source, int swap_flag,
+              MrmsByteOrderCache *byte_orders = 0, string *error = 0);
+    int parse(const unsigned char *buf, size_t len, int swap_flag,
+              size_t &needed);
+    bool plausible() const;
+    int crop(float south, float north, float west, float east,
+             int &first_row, int &first_col);
+
+    size_t numValues() const;
+    size_t headerBytes() const;
+    size_t fileBytes() const;
+    void clear();
+
+};
+//end class MrmsHeader
+
+
+
+class MrmsGrid
+{
+  public:
+
+    //default constructor
+    MrmsGrid();
+
+    //move constructor
+    MrmsGrid(MrmsGrid&& grid);
+
+    //destructor
+    ~MrmsGrid();
+
+    //non-copyable
+    MrmsGrid(const MrmsGrid& grid) = delete;
+
+
+    //public methods
+    int read(const char *vfname, int swap_flag,
+             MrmsByteOrderCache *byte_orders = 0);
+    int read(MrmsSource &source, int swap_flag,
+             MrmsByteOrderCache *byte_orders = 0);
+    int readLevels(const char *vfname, int swap_flag,
+                   int first_level, int num_levels,
+                   MrmsByteOrderCache *byte_orders = 0);
+    int readRows(const char *vfname, int swap_flag,
+                 int level, int first_row, int num_rows,
+                 MrmsByteOrderCache *byte_orders = 0);
+
+    const MrmsHeader& header() const { return hdr; }
+    const short int* data() const { return values; }
+    short int* data() { return values; }
+    size_t size() const { return numValues; }
+    bool empty() const { return (values == 0); }
+
+    //part of the file's data array held (all of it after read)
+    int firstLevel() const { return levelStart; }
+    int numLevels() const { return levelCount; }
+    int firstRow() const { return rowStart; }
+    int numRows() const { return rowCount; }
+
+    short int* release();
+    void clear();
+
+    void setInflateBackend(int backend);
+    int inflateBackend() const { return inflater; }
+
+    void setThreads(int num_threads);
+    int threads() const { return numThreads; }
+
+    void setMemoryMap(bool map_files) { mapFiles = map_files; }
+    bool mapped() const { return (mapping != 0); }
+
+    void setBufferPool(MrmsBufferPool *buffer_pool);
+    MrmsBufferPool* bufferPool() const { return pool; }
+
+    //why the last read failed, and anything odd about one that
+    //succeeded (empty if none)
+    const string& errorMessage() const { return errorText; }
+    const string& warningMessage() const { return warningText; }
+
+
+    //overloaded operators
+    MrmsGrid& operator= (MrmsGrid&& grid);
+    MrmsGrid& operator= (const MrmsGrid& grid) = delete;
+
+
+  private:
+
+    MrmsHeader hdr;
+    short int *values;
+    size_t numValues;
+
+    //allocation holding the data; values may point past its
+    //start when the whole file (header too) was inflated into it
+    short int *storage;
+    MrmsBufferPool *pool;   //where storage comes from (0 = new [])
+
+    int inflater;
+    int numThreads;
+
+    //memory-mapped file holding the data, if any
+    bool mapFiles;
+    void *mapping;
+    size_t mappingBytes;
+
+    int levelStart, levelCount;
+    int rowStart, rowCount;
+
+    string errorText;
+    string warningText;
+
+    int readRegion(const char *vfname, int swap_flag,
+                   int first_level, int num_levels,
+                   int first_row, int num_rows,
+                   MrmsByteOrderCache *byte_orders);
+    int readData(MrmsSource &source, int swap_flag,
+                 const unsigned char *leftover, size_t num_leftover);
+    int inflateFile(MrmsSource &source);
+    int inflateIndexed(const char *vfname);
+    int mapFile(const char *vfname);
+    short int* allocate(size_t num_values, int num_rows, int num_levels);
+    void clearData();
+
+};
+//end class MrmsGrid
+
+
+
+class MrmsSlabReader
+{
+  public:
+
+    //default constructor
+    MrmsSlabReader();
+
+    //destructor
+    ~MrmsSlabReader();
+
+    //non-copyable
+    MrmsSlabReader(const MrmsSlabReader& reader) = delete;
+    MrmsSlabReader& operator= (const MrmsSlabReader& reader) = delete;
+
+
+    //public methods
+    int open(const char *vfname, int swap_flag,
+             MrmsByteOrderCache *byte_orders = 0);
+    int open(MrmsSource &source, int swap_flag,
+             MrmsByteOrderCache *byte_orders = 0);
+    int crop(float south, float north, float west, float east);
+    int next(int num_rows = -1);
+    void close();
+
+    void setBufferPool(MrmsBufferPool *buffer_pool);
+
+    //why the last open, crop or next failed
+    const string& errorMessage() const { return errorText; }
+
+    const MrmsHeader& header() const { return hdr; }
+    const short int* data() const { return slab; }
+    short int* data() { return slab; }
+    size_t size() const { return numValues; }
+
+    //where the slab last read by next() lies in the grid of
+    //header() (the cropped grid, after crop)
+    int level() const { return levelNum; }
+    int firstRow() const { return rowStart; }
+    int numRows() const { return rowCount; }
+
+
+  private:
+
+    MrmsHeader hdr;
+
+    //source being read: the caller's, or fileSource when opened
+    //by name (0 = none)
+    MrmsSource *source;
+    MrmsSource fileSource;
+    string fileName;
+
+    //data bytes read along with the header, not yet handed out
+    vector<unsigned char> leftover;
+    size_t leftoverUsed;
+
+    //grid in the file, where the cropped grid starts in it, and
+    //how far into the data array the stream is
+    int fileNx, fileNy;
+    int cropRow, cropCol;
+    size_t dataPos;
+
+    //reused from slab to slab; only grows
+    short int *slab;
+    size_t slabCapacity;
+    size_t numValues;
+    MrmsBufferPool *pool;
+
+    int levelNum, rowStart, rowCount;
+    int nextLevel, nextRow;
+
+    string errorText;
+
+    int openSource(MrmsSource &input, int swap_flag,
+                   MrmsByteOrderCache *byte_orders);
+    int readBytes(void *dest, size_t num_bytes);
+    void freeSlab();
+
+};
+//end class MrmsSlabReader
+
+#endif
@@ -0,0 +1,734 @@
+#include <stdio.h>
+#include <string.h>
+#include <zlib.h>
+#include <thread>
+
+#include "MrmsGzIndex.h"
+
+using namespace std;
+
+
+// C O N S T A N T S
+
+//deflate window size
+static const unsigned int WINSIZE = 32768;
+
+//bytes read from the compressed file at a time
+static const size_t CHUNK = 65536;
+
+//identifies a sidecar index file (and its version)
+static const char SIDECAR_MAGIC[8] = {'M','R','M','S','G','Z','I','1'};
+
+
+
+// F U N C T I O N S
+
+/*------------------------------------------------------------------
+
+	Function:	read_gzip_trailer
+
+	Purpose:	Get the size of a file and the CRC32 and ISIZE
+	            fields of its gzip trailer
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+static int read_gzip_trailer(FILE *fp, uint64_t &file_bytes,
+                             uint32_t &crc, uint32_t &isize)
+{
+    unsigned char magic[2];
+    unsigned char trailer[8];
+
+    if( (fseek(fp, 0, SEEK_SET) != 0) || (fread(magic, 1, 2, fp) != 2) )
+      return -1;
+    if( (magic[0] != 0x1f) || (magic[1] != 0x8b) ) return -1;
+
+    if(fseek(fp, 0, SEEK_END) != 0) return -1;
+    long size = ftell(fp);
+    if(size < 18) return -1;
+
+    if( (fseek(fp, -8, SEEK_END) != 0) || (fread(trailer, 1, 8, fp) != 8) )
+      return -1;
+
+    file_bytes = (uint64_t)size;
+    crc = (uint32_t)trailer[0] | ((uint32_t)trailer[1] << 8)
+        | ((uint32_t)trailer[2] << 16) | ((uint32_t)trailer[3] << 24);
+    isize = (uint32_t)trailer[4] | ((uint32_t)trailer[5] << 8)
+          | ((uint32_t)trailer[6] << 16) | ((uint32_t)trailer[7] << 24);
+
+    return 1;
+}
+
+
+//fwrite/fread a single value; true on success
+template < class Data_Type >
+static bool put_value(FILE *fp, const Data_Type &value)
+{
+    return fwrite(&value, sizeof(Data_Type), 1, fp) == 1;
+}
+
+template < class Data_Type >
+static bool get_value(FILE *fp, Data_Type &value)
+{
+    return fread(&value, sizeof(Data_Type), 1, fp) == 1;
+}
+
+
+
+/*****************************/
+/*****************************/
+/** C O N S T R U C T O R S **/
+/*****************************/
+
+//default constructor
+MrmsGzIndex::MrmsGzIndex()
+{
+    clear();
+}
+
+/************************************/
+/** E N D  C O N S T R U C T O R S **/
+/************************************/
+/************************************/
+
+
+
+/********************************/
+/********************************/
+/** P U B L I C  M E T H O D S **/
+/********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		build
+
+	Purpose:	Inflate the whole file once, recording a
+	            checkpoint at the first block boundary after
+	            every span bytes of output
+
+	Input:		vfname = gzip'd MRMS binary file
+	            span = uncompressed distance between checkpoints
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsGzIndex::build(const char *vfname, size_t span)
+{
+    clear();
+    errorText.clear();
+
+    FILE *fp = fopen(vfname, "rb");
+    if(fp == NULL)
+    {
+      errorText = string("Could not open ") + vfname;
+      return -1;
+    }
+
+    if( read_gzip_trailer(fp, fileBytes, trailerCrc, trailerSize) < 0 )
+    {
+      errorText = string(vfname) + " is not gzip'd; no index needed";
+      fclose(fp);
+      return -1;
+    }
+
+    fseek(fp, 0, SEEK_SET);
+
+    dataFile = vfname;
+    spanBytes = (span > 0) ? span : MRMS_GZINDEX_SPAN;
+
+
+    //Inflate, stopping at the end of each deflate block (Z_BLOCK)
+    z_stream strm;
+    memset(&strm, 0, sizeof(z_stream));
+    if( inflateInit2(&strm, 15+16) != Z_OK )
+    {
+      fclose(fp);
+      return -1;
+    }
+
+    vector<unsigned char> input(CHUNK);
+    vector<unsigned char> window(WINSIZE);
+
+    uint64_t totin = 0, totout = 0, last = 0;
+    int ret = Z_OK;
+    int status = 1;
+
+    strm.avail_out = 0;
+
+    do
+    {
+      strm.avail_in = (unsigned int)fread(input.data(), 1, CHUNK, fp);
+      if( ferror(fp) || (strm.avail_in == 0) )
+      {
+        status = -1;
+        break;
+      }
+      strm.next_in = input.data();
+
+      do
+      {
+        if(strm.avail_out == 0)
+        {
+          strm.avail_out = WINSIZE;
+          strm.next_out = window.data();
+        }
+
+        totin += strm.avail_in;
+        totout += strm.avail_out;
+        ret = inflate(&strm, Z_BLOCK);
+        totin -= strm.avail_in;
+        totout -= strm.avail_out;
+
+        if( (ret == Z_NEED_DICT) || (ret == Z_DATA_ERROR) ||
+            (ret == Z_MEM_ERROR) || (ret == Z_STREAM_ERROR) )
+        {
+          status = -1;
+          break;
+        }
+
+        if(ret == Z_STREAM_END) break;
+
+        //At the end of a block (but not the last one): checkpoint
+        //here if far enough from the last one
+        if( (strm.data_type & 128) && !(strm.data_type & 64) &&
+            ( (totout == 0) || (totout - last > spanBytes) ) )
+        {
+          if( addPoint(strm.data_type & 7, totin, totout,
+                       strm.avail_out, window.data()) < 0 )
+          {
+            status = -1;
+            break;
+          }
+
+          last = totout;
+        }
+
+      } while(strm.avail_in != 0);
+
+    } while( (status > 0) && (ret != Z_STREAM_END) );
+
+    inflateEnd(&strm);
+    fclose(fp);
+
+
+    //Only single-member files can be indexed
+    if( (status > 0) && (totin != fileBytes) )
+    {
+      errorText = string(vfname) + " has more than one gzip member; "
+                + "not indexed";
+      status = -1;
+    }
+    else if(status < 0)
+    {
+      errorText = string("Corrupt or truncated gzip data in ") + vfname;
+    }
+
+    if(status < 0) clear();
+
+    return status;
+
+}//end public method MrmsGzIndex::build
+
+
+/*------------------------------------------------------------------
+
+	Method:		load
+
+	Purpose:	Read the sidecar index of a file.  Fails quietly
+	            (returns -1) if there is none, or if it was built
+	            from a different version of the file.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsGzIndex::load(const char *vfname)
+{
+    clear();
+    errorText.clear();
+
+    //What the data file looks like now
+    FILE *fp = fopen(vfname, "rb");
+    if(fp == NULL) return -1;
+
+    uint64_t cur_bytes;
+    uint32_t cur_crc, cur_size;
+    int status = read_gzip_trailer(fp, cur_bytes, cur_crc, cur_size);
+    fclose(fp);
+
+    if(status < 0) return -1;
+
+
+    //What the index was built from
+    string sidecar = sidecarName(vfname);
+    fp = fopen(sidecar.c_str(), "rb");
+    if(fp == NULL) return -1;
+
+    char magic[8];
+    uint64_t span = 0, num_points = 0;
+
+    bool ok = (fread(magic, 1, 8, fp) == 8)
+           && (memcmp(magic, SIDECAR_MAGIC, 8) == 0)
+           && get_value(fp, fileBytes) && get_value(fp, trailerCrc)
+           && get_value(fp, trailerSize) && get_value(fp, span)
+           && get_value(fp, num_points);
+
+    ok = ok && (fileBytes == cur_bytes) && (trailerCrc == cur_crc)
+            && (trailerSize == cur_size) && (num_points <= fileBytes);
+
+    for(uint64_t p = 0; ok && (p < num_points); p++)
+    {
+      MrmsGzCheckpoint point;
+      uint32_t zlen = 0;
+
+      ok = get_value(fp, point.out) && get_value(fp, point.in)
+        && get_value(fp, point.bits) && get_value(fp, point.windowBytes)
+        && get_value(fp, zlen);
+
+      ok = ok && (point.in <= fileBytes) && (point.bits >= 0) && (point.bits < 8)
+              && (point.windowBytes <= WINSIZE) && (zlen <= compressBound(WINSIZE));
+
+      if(ok)
+      {
+        point.window.resize(zlen);
+        ok = (fread(point.window.data(), 1, zlen, fp) == zlen);
+      }
+
+      if(ok) points.push_back(point);
+    }
+
+    fclose(fp);
+
+    if(!ok || points.empty())
+    {
+      clear();
+      return -1;
+    }
+
+    dataFile = vfname;
+    spanBytes = (size_t)span;
+
+    return 1;
+
+}//end public method MrmsGzIndex::load
+
+
+/*------------------------------------------------------------------
+
+	Method:		save
+
+	Purpose:	Write the index to its sidecar file.  The file is
+	            written under a temporary name and renamed, so a
+	            reader never sees a partial index.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsGzIndex::save() const
+{
+    errorText.clear();
+
+    if( points.empty() )
+    {
+      errorText = "Nothing to save; index is empty";
+      return -1;
+    }
+
+    string sidecar = sidecarName(dataFile.c_str());
+    string temp = sidecar + ".tmp";
+
+    FILE *fp = fopen(temp.c_str(), "wb");
+    if(fp == NULL)
+    {
+      errorText = "Could not create " + temp;
+      return -1;
+    }
+
+    uint64_t span = spanBytes;
+    uint64_t num_points = points.size();
+
+    bool ok = (fwrite(SIDECAR_MAGIC, 1, 8, fp) == 8)
+           && put_value(fp, fileBytes) && put_value(fp, trailerCrc)
+           && put_value(fp, trailerSize) && put_value(fp, span)
+           && put_value(fp, num_points);
+
+    for(size_t p = 0; ok && (p < points.size()); p++)
+    {
+      const MrmsGzCheckpoint &point = points[p];
+      uint32_t zlen = (uint32_t)point.window.size();
+
+      ok = put_value(fp, point.out) && put_value(fp, point.in)
+        && put_value(fp, point.bits) && put_value(fp, point.windowBytes)
+        && put_value(fp, zlen)
+        && (fwrite(point.window.data(), 1, zlen, fp) == zlen);
+    }
+
+    if(fclose(fp) != 0) ok = false;
+
+    if( !ok || (rename(temp.c_str(), sidecar.c_str()) != 0) )
+    {
+      errorText = "Could not write " + sidecar;
+      remove(temp.c_str());
+      return -1;
+    }
+
+    return 1;
+
+}//end public method MrmsGzIndex::save
+
+
+/*------------------------------------------------------------------
+
+	Method:		open
+
+	Purpose:	Load the sidecar index of a file, building (and
+	            saving) it first if it is missing or stale.  An
+	            index that cannot be saved is still usable.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsGzIndex::open(const char *vfname, size_t span)
+{
+    if( load(vfname) > 0 ) return 1;
+
+    if( build(vfname, span) < 0 ) return -1;
+
+    save();
+
+    return 1;
+
+}//end public method MrmsGzIndex::open
+
+
+/*------------------------------------------------------------------
+
+	Method:		extract
+
+	Purpose:	Inflate len bytes of the file starting at
+	            uncompressed offset, beginning at the nearest
+	            checkpoint at or before offset
+
+	Output:		buf = the bytes
+	            int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsGzIndex::extract(size_t offset, void *buf, size_t len) const
+{
+    if( points.empty() ) return -1;
+    if(len == 0) return 1;
+
+    //last checkpoint at or before offset
+    size_t lo = 0, hi = points.size();
+    while(hi - lo > 1)
+    {
+      size_t mid = (lo + hi)/2;
+      if(points[mid].out <= offset) lo = mid;
+      else hi = mid;
+    }
+
+    if(points[lo].out > offset) return -1;
+
+    return inflateFrom(lo, offset - (size_t)points[lo].out,
+                       static_cast< unsigned char * >( buf ), len, 0);
+
+}//end public method MrmsGzIndex::extract
+
+
+/*------------------------------------------------------------------
+
+	Method:		inflateAll
+
+	Purpose:	Inflate the whole file with up to num_threads
+	            threads.  The checkpoints are split into
+	            num_threads runs of about equal size; each thread
+	            inflates its run straight into its slice of buf
+	            and computes the slice's CRC32.  The slice CRCs are
+	            combined and must match the gzip trailer, so any
+	            bad slice fails the whole call and the caller can
+	            fall back to a serial read.
+
+	Input:		len = size of the uncompressed file; must match
+	                  the gzip trailer's ISIZE
+
+	Output:		buf = the file's bytes
+	            int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsGzIndex::inflateAll(void *buf, size_t len, int num_threads) const
+{
+    if( points.empty() || ((uint32_t)len != trailerSize) ) return -1;
+    if( points.back().out >= len ) return -1;
+
+    if(num_threads < 1) num_threads = 1;
+    if((size_t)num_threads > points.size()) num_threads = (int)points.size();
+
+
+    //First checkpoint of each run, splitting the output evenly
+    vector<size_t> first(num_threads+1, points.size());
+    first[0] = 0;
+
+    for(int t = 1; t < num_threads; t++)
+    {
+      size_t target = len/num_threads * t;
+      size_t p = first[t-1] + 1;
+      while( (p < points.size()) && (points[p].out < target) ) p++;
+      first[t] = p;
+    }
+
+
+    //Inflate the runs
+    vector<int> status(num_threads, -1);
+    vector<uint32_t> crc(num_threads, 0);
+    vector<size_t> run_bytes(num_threads, 0);
+    vector<thread> workers;
+    unsigned char *dest = static_cast< unsigned char * >( buf );
+
+    for(int t = 0; t < num_threads; t++)
+    {
+      if(first[t] >= points.size()) break;
+
+      size_t start = (size_t)points[first[t]].out;
+      size_t end = (first[t+1] < points.size()) ? (size_t)points[first[t+1]].out : len;
+      run_bytes[t] = end - start;
+
+      workers.push_back( thread( [this, &first, &status, &crc, &run_bytes, dest, start, t]()
+      {
+        crc[t] = (uint32_t)crc32(0L, Z_NULL, 0);
+        status[t] = inflateFrom(first[t], 0, dest + start, run_bytes[t], &crc[t]);
+      } ) );
+    }
+
+    for(size_t w = 0; w < workers.size(); w++) workers[w].join();
+
+
+    //Verify against the gzip trailer
+    uint32_t total_crc = (uint32_t)crc32(0L, Z_NULL, 0);
+
+    for(size_t t = 0; t < workers.size(); t++)
+    {
+      if(status[t] < 0) return -1;
+      total_crc = (uint32_t)crc32_combine(total_crc, crc[t], (z_off_t)run_bytes[t]);
+    }
+
+    if(total_crc != trailerCrc) return -1;
+
+    return 1;
+
+}//end public method MrmsGzIndex::inflateAll
+
+
+/*------------------------------------------------------------------
+
+	Method:		sidecarName
+
+	Purpose:	Name of the sidecar index file for a data file
+
+------------------------------------------------------------------*/
+
+string MrmsGzIndex::sidecarName(const char *vfname)
+{
+    return string(vfname) + ".gzidx";
+
+}//end public method MrmsGzIndex::sidecarName
+
+
+/*------------------------------------------------------------------
+
+	Method:		clear
+
+	Purpose:	Clears object to original (blank) state
+
+------------------------------------------------------------------*/
+
+void MrmsGzIndex::clear()
+{
+    dataFile.clear();
+    fileBytes = 0;
+    trailerCrc = 0;
+    trailerSize = 0;
+    spanBytes = MRMS_GZINDEX_SPAN;
+    points.clear();
+
+}//end public method MrmsGzIndex::clear
+
+/***************************************/
+/** E N D  P U B L I C  M E T H O D S **/
+/***************************************/
+/***************************************/
+
+
+
+/**********************************/
+/**********************************/
+/** P R I V A T E  M E T H O D S **/
+/**********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		addPoint
+
+	Purpose:	Record a checkpoint.  The window holds the last
+	            32K of output as a circular buffer, with the
+	            oldest bytes starting "left" bytes from its end.
+
+------------------------------------------------------------------*/
+
+int MrmsGzIndex::addPoint(int bits, uint64_t in, uint64_t out,
+                          unsigned int left, const unsigned char *window)
+{
+    MrmsGzCheckpoint point;
+    point.out = out;
+    point.in = in;
+    point.bits = bits;
+    point.windowBytes = (out < WINSIZE) ? (uint32_t)out : WINSIZE;
+
+    //Unroll the circular window, keeping only bytes already output
+    vector<unsigned char> flat(WINSIZE);
+    if(left) memcpy(flat.data(), window + WINSIZE - left, left);
+    if(left < WINSIZE) memcpy(flat.data() + left, window, WINSIZE - left);
+
+    const unsigned char *start = flat.data() + WINSIZE - point.windowBytes;
+
+    uLongf zlen = compressBound(WINSIZE);
+    point.window.resize(zlen);
+
+    if( compress2(point.window.data(), &zlen, start, point.windowBytes,
+                  Z_BEST_SPEED) != Z_OK )
+      return -1;
+
+    point.window.resize(zlen);
+    points.push_back(point);
+
+    return 1;
+
+}//end private method MrmsGzIndex::addPoint
+
+/*------------------------------------------------------------------
+
+	Method:		inflateFrom
+
+	Purpose:	Restore the inflate state at checkpoint p, discard
+	            skip bytes, then inflate len bytes into dest.
+	            If crc is given, the CRC32 of the len bytes is
+	            accumulated into it.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsGzIndex::inflateFrom(size_t p, size_t skip, unsigned char *dest,
+                             size_t len, uint32_t *crc) const
+{
+    const MrmsGzCheckpoint &point = points[p];
+
+    //Restore the inflate state at the checkpoint
+    FILE *fp = fopen(dataFile.c_str(), "rb");
+    if(fp == NULL) return -1;
+
+    if( fseek(fp, (long)(point.in - (point.bits ? 1 : 0)), SEEK_SET) != 0 )
+    {
+      fclose(fp);
+      return -1;
+    }
+
+    z_stream strm;
+    memset(&strm, 0, sizeof(z_stream));
+    if( inflateInit2(&strm, -15) != Z_OK )
+    {
+      fclose(fp);
+      return -1;
+    }
+
+    int status = 1;
+
+    if(point.bits)
+    {
+      int ch = getc(fp);
+      if( (ch == EOF) || (inflatePrime(&strm, point.bits, ch >> (8 - point.bits)) != Z_OK) )
+        status = -1;
+    }
+
+    vector<unsigned char> window(WINSIZE);
+
+    if( (status > 0) && (point.windowBytes > 0) )
+    {
+      uLongf window_bytes = WINSIZE;
+
+      if( (uncompress(window.data(), &window_bytes, point.window.data(),
+                      point.window.size()) != Z_OK) ||
+          (window_bytes != point.windowBytes) ||
+          (inflateSetDictionary(&strm, window.data(), point.windowBytes) != Z_OK) )
+        status = -1;
+    }
+
+
+    //Inflate, discarding up to offset (into window), then into buf
+    vector<unsigned char> input(CHUNK);
+    size_t remaining = len;
+
+    while( (status > 0) && (remaining > 0) )
+    {
+      if(strm.avail_in == 0)
+      {
+        strm.avail_in = (unsigned int)fread(input.data(), 1, CHUNK, fp);
+        strm.next_in = input.data();
+
+        if(strm.avail_in == 0)
+        {
+          status = -1;
+          break;
+        }
+      }
+
+      size_t want;
+      if(skip > 0)
+      {
+        want = (skip < WINSIZE) ? skip : WINSIZE;
+        strm.next_out = window.data();
+      }
+      else
+      {
+        want = (remaining < ((size_t)1 << 30)) ? remaining : ((size_t)1 << 30);
+        strm.next_out = dest;
+      }
+      strm.avail_out = (unsigned int)want;
+
+      int ret = inflate(&strm, Z_NO_FLUSH);
+      if( (ret != Z_OK) && (ret != Z_STREAM_END) && (ret != Z_BUF_ERROR) )
+      {
+        status = -1;
+        break;
+      }
+
+      size_t have = want - strm.avail_out;
+      if(skip > 0) skip -= have;
+      else
+      {
+        if(crc != 0) *crc = (uint32_t)crc32_z(*crc, dest, have);
+        dest += have;
+        remaining -= have;
+      }
+
+      if( (ret == Z_STREAM_END) && (remaining > 0) ) status = -1;
+    }
+
+    inflateEnd(&strm);
+    fclose(fp);
+
+    return status;
+
+}//end private method MrmsGzIndex::inflateFrom
+
+/*****************************************/
+/** E N D  P R I V A T E  M E T H O D S **/
+/*****************************************/
+/*****************************************/
+
+//End Class MrmsGzIndex
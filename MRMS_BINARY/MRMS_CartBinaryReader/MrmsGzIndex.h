@@ -0,0 +1,121 @@
+#ifndef MRMSGZINDEX_H
+#define MRMSGZINDEX_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <stdint.h>
+
+using namespace std;
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	File:		MrmsGzIndex
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	Random-access index for a gzip'd MRMS binary file,
+	            in the style of zlib's examples/zran.c.
+
+	            While the file is inflated once, a checkpoint is
+	            recorded at the first deflate block boundary after
+	            every span bytes of output: the uncompressed and
+	            compressed offsets, the bit offset into the
+	            compressed byte, and the 32K window needed to
+	            resume inflating there.  extract() then starts
+	            from the nearest checkpoint at or before the bytes
+	            wanted instead of from the start of the file.
+
+	            The index is kept in a sidecar file next to the
+	            data (<file>.gzidx).  It records the compressed
+	            size and gzip trailer of the file it was built
+	            from, and is ignored if they no longer match.
+	            Windows are stored deflated.  The sidecar is
+	            written in host byte order; a sidecar from a host
+	            of the other byte order is simply rebuilt.
+
+	            inflateAll() uses the checkpoints to inflate a
+	            whole file on several threads at once, verified
+	            against the trailer's CRC32.
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+// C O N S T A N T S
+
+//default uncompressed distance between checkpoints
+static const size_t MRMS_GZINDEX_SPAN = 4*1024*1024;
+
+
+
+class MrmsGzCheckpoint
+{
+  public:
+
+    uint64_t out;     //offset in the uncompressed data
+    uint64_t in;      //offset of the first full byte in the file
+    int bits;         //bits of the byte before "in" to use (0-7)
+    uint32_t windowBytes;            //size of the window when inflated
+    vector<unsigned char> window;    //deflated 32K window
+
+};
+//end class MrmsGzCheckpoint
+
+
+
+class MrmsGzIndex
+{
+  public:
+
+    //default constructor
+    MrmsGzIndex();
+
+    //public methods
+    int build(const char *vfname, size_t span = MRMS_GZINDEX_SPAN);
+    int load(const char *vfname);
+    int save() const;
+    int open(const char *vfname, size_t span = MRMS_GZINDEX_SPAN);
+
+    int extract(size_t offset, void *buf, size_t len) const;
+    int inflateAll(void *buf, size_t len, int num_threads) const;
+
+    bool empty() const { return points.empty(); }
+    size_t numPoints() const { return points.size(); }
+    size_t span() const { return spanBytes; }
+    const string& fileName() const { return dataFile; }
+    void clear();
+
+    //why the last build or save failed
+    const string& errorMessage() const { return errorText; }
+
+    static string sidecarName(const char *vfname);
+
+
+  private:
+
+    string dataFile;
+
+    //what the index was built from
+    uint64_t fileBytes;
+    uint32_t trailerCrc;
+    uint32_t trailerSize;
+
+    size_t spanBytes;
+    vector<MrmsGzCheckpoint> points;
+
+    mutable string errorText;
+
+    int addPoint(int bits, uint64_t in, uint64_t out,
+                 unsigned int left, const unsigned char *window);
+    int inflateFrom(size_t p, size_t skip, unsigned char *dest,
+                    size_t len, uint32_t *crc) const;
+
+};
+//end class MrmsGzIndex
+
+#endif
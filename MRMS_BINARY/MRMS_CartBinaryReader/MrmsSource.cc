@@ -0,0 +1,680 @@
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "MrmsSource.h"
+
+using namespace std;
+
+
+// C O N S T A N T S
+
+//bytes pulled from a callback at a time
+static const size_t CHUNK = 262144;
+
+//largest count handed to one zlib call (counts are unsigned int)
+static const size_t MAX_ZLIB_BYTES = (size_t)1 << 30;
+
+//Upper bound on the deflate compression ratio, used to reject
+//absurd sizes in gzip'd input
+static const size_t MAX_DEFLATE_RATIO = 1032;
+
+
+
+// F U N C T I O N S
+
+/*------------------------------------------------------------------
+
+	Function:	is_gzip
+
+	Purpose:	True if the bytes start with the gzip magic number
+
+------------------------------------------------------------------*/
+
+static bool is_gzip(const unsigned char *bytes, size_t num_bytes)
+{
+    return (num_bytes >= 2) && (bytes[0] == 0x1f) && (bytes[1] == 0x8b);
+}
+
+
+
+/*****************************/
+/*****************************/
+/** C O N S T R U C T O R S **/
+/*****************************/
+
+//default constructor
+MrmsSource::MrmsSource()
+{
+    kind = NONE;
+    fpGzip = 0;
+    strmReady = false;
+    memset(&strm, 0, sizeof(strm));
+    close();
+}
+
+
+//deconstructor
+MrmsSource::~MrmsSource()
+{
+    close();
+}
+
+/************************************/
+/** E N D  C O N S T R U C T O R S **/
+/************************************/
+/************************************/
+
+
+
+/********************************/
+/********************************/
+/** P U B L I C  M E T H O D S **/
+/********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		open (file path)
+
+	Purpose:	Read a file by name.  The file's size and gzip
+	            trailer are read up front so that truncated files
+	            can be caught from the header alone.  Any source
+	            already open is closed first.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsSource::open(const char *vfname)
+{
+    close();
+
+    fpGzip = gzopen(vfname, "rb");
+    if( fpGzip == (gzFile) NULL )
+    {
+      fpGzip = 0;
+      return -1;
+    }
+
+    kind = PATH;
+    sourceName = vfname;
+
+    FILE *fp = fopen(vfname, "rb");
+    if(fp == NULL) return 1;
+
+    unsigned char magic[2];
+    unsigned char trailer[4];
+
+    if( (fread(magic, 1, 2, fp) == 2) && (fseek(fp, 0, SEEK_END) == 0) )
+    {
+      long size = ftell(fp);
+      gzipped = is_gzip(magic, 2);
+
+      if(size >= 0)
+      {
+        bool have_trailer = gzipped && (size >= 18) &&
+                            (fseek(fp, -4, SEEK_END) == 0) &&
+                            (fread(trailer, 1, 4, fp) == 4);
+
+        setSize((size_t)size, have_trailer ? trailer : 0);
+      }
+    }
+
+    fclose(fp);
+
+    return 1;
+
+}//end public method MrmsSource::open (file path)
+
+
+/*------------------------------------------------------------------
+
+	Method:		open (buffer)
+
+	Purpose:	Read a file that is already in memory.  buf is not
+	            copied and must stay valid until close.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsSource::open(const void *buf, size_t num_bytes, const char *name)
+{
+    close();
+
+    if(buf == 0) return -1;
+
+    kind = MEMORY;
+    sourceName = name;
+
+    memBuf = static_cast< const unsigned char * >( buf );
+    memBytes = num_bytes;
+    inPos = memBuf;
+    inLeft = memBytes;
+    inEnd = true;
+
+    gzipped = is_gzip(memBuf, memBytes);
+    setSize(memBytes, (memBytes >= 18) ? memBuf + memBytes - 4 : 0);
+
+    return startInput();
+
+}//end public method MrmsSource::open (buffer)
+
+
+/*------------------------------------------------------------------
+
+	Method:		open (file descriptor)
+
+	Purpose:	Read an open file, pipe or socket from its current
+	            offset.  The descriptor is duplicated, so the
+	            caller still owns (and closes) fd.  Sizes are
+	            only checked against regular files.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsSource::open(int fd, const char *name)
+{
+    close();
+
+    if(fd < 0) return -1;
+
+    //size and trailer of a regular file, read without moving
+    //the offset
+    struct stat st;
+    off_t offset = lseek(fd, 0, SEEK_CUR);
+
+    if( (fstat(fd, &st) == 0) && S_ISREG(st.st_mode) &&
+        (offset >= 0) && (st.st_size >= offset) )
+    {
+      unsigned char magic[2];
+      unsigned char trailer[4];
+      size_t size = (size_t)(st.st_size - offset);
+
+      gzipped = (pread(fd, magic, 2, offset) == 2) && is_gzip(magic, 2);
+
+      bool have_trailer = gzipped && (size >= 18) &&
+                          (pread(fd, trailer, 4, st.st_size - 4) == 4);
+
+      setSize(size, have_trailer ? trailer : 0);
+    }
+
+    int read_fd = dup(fd);
+    if(read_fd < 0)
+    {
+      close();
+      return -1;
+    }
+
+    fpGzip = gzdopen(read_fd, "rb");
+    if( fpGzip == (gzFile) NULL )
+    {
+      fpGzip = 0;
+      ::close(read_fd);
+      close();
+      return -1;
+    }
+
+    kind = FD;
+    sourceName = name;
+
+    return 1;
+
+}//end public method MrmsSource::open (file descriptor)
+
+
+/*------------------------------------------------------------------
+
+	Method:		open (callback)
+
+	Purpose:	Read bytes pulled from a callback as they are
+	            needed.  The input size is unknown, so truncation
+	            shows up as a short read.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsSource::open(MrmsPullFunc pull, void *user, const char *name)
+{
+    close();
+
+    if(pull == 0) return -1;
+
+    kind = PULL;
+    sourceName = name;
+
+    pullFunc = pull;
+    pullUser = user;
+    chunk.resize(CHUNK);
+
+    //the first pull(s) tell whether the input is gzip'd
+    if(fillMagic() < 0)
+    {
+      close();
+      return -1;
+    }
+
+    gzipped = is_gzip(inPos, inLeft);
+
+    return startInput();
+
+}//end public method MrmsSource::open (callback)
+
+
+/*------------------------------------------------------------------
+
+	Method:		close
+
+	Purpose:	Release the source.  A caller's buffer or file
+	            descriptor is left alone.
+
+------------------------------------------------------------------*/
+
+void MrmsSource::close()
+{
+    if(fpGzip != 0) gzclose( fpGzip );
+    if(strmReady) inflateEnd(&strm);
+
+    kind = NONE;
+    sourceName.clear();
+    gzipped = false;
+    sizeKnown = false;
+    inputBytes = 0;
+    isize = 0;
+    fpGzip = 0;
+    memBuf = 0;
+    memBytes = 0;
+    pullFunc = 0;
+    pullUser = 0;
+    chunk.clear();
+    inPos = 0;
+    inLeft = 0;
+    inEnd = false;
+    strmReady = false;
+    strmEnd = false;
+
+}//end public method MrmsSource::close
+
+
+/*------------------------------------------------------------------
+
+	Method:		read
+
+	Purpose:	Read the next num_bytes of (uncompressed) input
+
+	Output:		long = bytes read, short only at the end of the
+	            input; -1 on error
+
+------------------------------------------------------------------*/
+
+long MrmsSource::read(void *dest, size_t num_bytes)
+{
+    unsigned char *out = static_cast< unsigned char * >( dest );
+
+    if( (kind == PATH) || (kind == FD) )
+    {
+      size_t got = 0;
+
+      while(got < num_bytes)
+      {
+        size_t want = num_bytes - got;
+        if(want > MAX_ZLIB_BYTES) want = MAX_ZLIB_BYTES;
+
+        int num_read = gzread(fpGzip, out + got, (unsigned int)want);
+        if(num_read < 0) return -1;
+
+        got += (size_t)num_read;
+        if((size_t)num_read < want) break;
+      }
+
+      return (long)got;
+    }
+
+    if( (kind == MEMORY) || (kind == PULL) )
+    {
+      if(gzipped) return readInflate(out, num_bytes);
+      return readRaw(out, num_bytes);
+    }
+
+    return -1;
+
+}//end public method MrmsSource::read
+
+
+/*------------------------------------------------------------------
+
+	Method:		readAll
+
+	Purpose:	Read exactly num_bytes
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsSource::readAll(void *dest, size_t num_bytes)
+{
+    return ( read(dest, num_bytes) == (long)num_bytes ) ? 1 : -1;
+
+}//end public method MrmsSource::readAll
+
+
+/*------------------------------------------------------------------
+
+	Method:		skip
+
+	Purpose:	Skip the next num_bytes of (uncompressed) input
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsSource::skip(size_t num_bytes)
+{
+    if( (kind == PATH) || (kind == FD) )
+    {
+      if( gzseek(fpGzip, (z_off_t)num_bytes, SEEK_CUR) < 0 ) return -1;
+      return 1;
+    }
+
+    //plain bytes in memory: just move past them
+    if( (kind == MEMORY) && !gzipped )
+    {
+      if(num_bytes > inLeft) return -1;
+
+      inPos += num_bytes;
+      inLeft -= num_bytes;
+      return 1;
+    }
+
+    vector<unsigned char> scratch( (num_bytes < CHUNK) ? num_bytes : CHUNK );
+
+    while(num_bytes > 0)
+    {
+      size_t want = (num_bytes < scratch.size()) ? num_bytes : scratch.size();
+
+      if( readAll(scratch.data(), want) < 0 ) return -1;
+      num_bytes -= want;
+    }
+
+    return 1;
+
+}//end public method MrmsSource::skip
+
+
+//true if the input can hold at least num_bytes.  ISIZE is not
+//used: a multi-member gzip file's trailer gives only the size of
+//its last member
+bool MrmsSource::canHold(size_t num_bytes) const
+{
+    if(!sizeKnown) return true;
+    if(!gzipped) return (num_bytes <= inputBytes);
+
+    return (num_bytes <= inputBytes*MAX_DEFLATE_RATIO);
+}
+
+
+//true if the input may hold exactly num_bytes (plain files may
+//have trailing bytes after the data array).  For gzip input ISIZE
+//is advisory: an exact match (mod 2^32) passes, and so does any
+//ISIZE that could be the last member of a multi-member file
+bool MrmsSource::matches(size_t num_bytes) const
+{
+    if(!sizeKnown) return true;
+    if(!gzipped) return (num_bytes <= inputBytes);
+    if(!canHold(num_bytes)) return false;
+
+    if(matchesExactly(num_bytes)) return true;
+
+    //ISIZE is exact when the stream cannot reach 4 GB
+    if(inputBytes*MAX_DEFLATE_RATIO < ((size_t)1 << 32))
+      return (isize <= num_bytes);
+
+    return true;
+}
+
+
+//true if the input is known to hold num_bytes: the size of a plain
+//file, or the ISIZE of a (single-member) gzip file, agrees with it
+bool MrmsSource::matchesExactly(size_t num_bytes) const
+{
+    if(!sizeKnown) return false;
+    if(!gzipped) return (num_bytes <= inputBytes);
+
+    return canHold(num_bytes) && ((num_bytes & 0xffffffffUL) == isize);
+}
+
+/***************************************/
+/** E N D  P U B L I C  M E T H O D S **/
+/***************************************/
+/***************************************/
+
+
+
+/**********************************/
+/**********************************/
+/** P R I V A T E  M E T H O D S **/
+/**********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		setSize
+
+	Purpose:	Record the size of the input and, when gzip'd, the
+	            ISIZE field of its trailer (uncompressed size
+	            modulo 2^32).  A gzip'd input without a trailer
+	            has an unknown size.
+
+------------------------------------------------------------------*/
+
+void MrmsSource::setSize(size_t input_bytes, const unsigned char *trailer)
+{
+    inputBytes = input_bytes;
+    sizeKnown = !gzipped;
+
+    if(gzipped && (trailer != 0))
+    {
+      isize = (size_t)trailer[0] | ((size_t)trailer[1] << 8)
+            | ((size_t)trailer[2] << 16) | ((size_t)trailer[3] << 24);
+      sizeKnown = true;
+    }
+
+}//end private method MrmsSource::setSize
+
+
+/*------------------------------------------------------------------
+
+	Method:		fill
+
+	Purpose:	Pull the next chunk of raw input once the last one
+	            is used up (callback sources only)
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsSource::fill()
+{
+    if( (kind != PULL) || (inLeft > 0) || inEnd ) return 1;
+
+    long num_read = pullFunc(pullUser, chunk.data(), chunk.size());
+    if(num_read < 0) return -1;
+
+    if(num_read == 0) inEnd = true;
+
+    inPos = chunk.data();
+    inLeft = (size_t)num_read;
+
+    return 1;
+
+}//end private method MrmsSource::fill
+
+
+/*------------------------------------------------------------------
+
+	Method:		fillMagic
+
+	Purpose:	Make sure the two bytes of a gzip magic number are
+	            in the chunk unless the input ends first (callback
+	            sources only; a pull may return a single byte).  A
+	            byte left over is moved to the front of the chunk
+	            and the next pull appended to it.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsSource::fillMagic()
+{
+    while( (kind == PULL) && (inLeft < 2) && !inEnd )
+    {
+      if(inLeft > 0) memmove(chunk.data(), inPos, inLeft);
+
+      long num_read = pullFunc(pullUser, chunk.data() + inLeft,
+                               chunk.size() - inLeft);
+      if(num_read < 0) return -1;
+
+      if(num_read == 0) inEnd = true;
+
+      inPos = chunk.data();
+      inLeft += (size_t)num_read;
+    }
+
+    return 1;
+
+}//end private method MrmsSource::fillMagic
+
+
+/*------------------------------------------------------------------
+
+	Method:		startInput
+
+	Purpose:	Set up inflating for gzip'd memory or callback
+	            input (gzip wrapper only; members are inflated one
+	            after another, as gzread does)
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsSource::startInput()
+{
+    if(!gzipped) return 1;
+
+    memset(&strm, 0, sizeof(strm));
+    if( inflateInit2(&strm, 16 + MAX_WBITS) != Z_OK )
+    {
+      close();
+      return -1;
+    }
+
+    strmReady = true;
+
+    return 1;
+
+}//end private method MrmsSource::startInput
+
+
+/*------------------------------------------------------------------
+
+	Method:		readRaw
+
+	Purpose:	Copy plain (not gzip'd) memory or callback input
+
+	Output:		long = bytes read, or -1 on error
+
+------------------------------------------------------------------*/
+
+long MrmsSource::readRaw(unsigned char *dest, size_t num_bytes)
+{
+    size_t got = 0;
+
+    while(got < num_bytes)
+    {
+      if( fill() < 0 ) return -1;
+      if(inLeft == 0) break;
+
+      size_t take = num_bytes - got;
+      if(take > inLeft) take = inLeft;
+
+      memcpy(dest + got, inPos, take);
+      inPos += take;
+      inLeft -= take;
+      got += take;
+    }
+
+    return (long)got;
+
+}//end private method MrmsSource::readRaw
+
+
+/*------------------------------------------------------------------
+
+	Method:		readInflate
+
+	Purpose:	Inflate gzip'd memory or callback input.  A member
+	            followed by another gzip member carries on into
+	            it; anything else after a member ends the input.
+
+	Output:		long = bytes read, or -1 on error
+
+------------------------------------------------------------------*/
+
+long MrmsSource::readInflate(unsigned char *dest, size_t num_bytes)
+{
+    size_t got = 0;
+
+    while( (got < num_bytes) && !strmEnd )
+    {
+      if(strm.avail_in == 0)
+      {
+        if( fill() < 0 ) return -1;
+        if(inLeft == 0) break;   //input ends inside a member
+
+        size_t take = (inLeft < MAX_ZLIB_BYTES) ? inLeft : MAX_ZLIB_BYTES;
+        strm.next_in = const_cast< Bytef * >( inPos );
+        strm.avail_in = (unsigned int)take;
+        inPos += take;
+        inLeft -= take;
+      }
+
+      size_t want = num_bytes - got;
+      if(want > MAX_ZLIB_BYTES) want = MAX_ZLIB_BYTES;
+
+      strm.next_out = dest + got;
+      strm.avail_out = (unsigned int)want;
+
+      int ret = inflate(&strm, Z_NO_FLUSH);
+      got += want - strm.avail_out;
+
+      if(ret == Z_STREAM_END)
+      {
+        //hand the unused input back, then look for another member
+        inPos -= strm.avail_in;
+        inLeft += strm.avail_in;
+        strm.avail_in = 0;
+
+        if( fillMagic() < 0 ) return -1;
+
+        if( is_gzip(inPos, inLeft) ) inflateReset(&strm);
+        else strmEnd = true;
+      }
+      else if( (ret != Z_OK) && (ret != Z_BUF_ERROR) )
+      {
+        return -1;
+      }
+    }
+
+    return (long)got;
+
+}//end private method MrmsSource::readInflate
+
+/*****************************************/
+/** E N D  P R I V A T E  M E T H O D S **/
+/*****************************************/
+/*****************************************/
+
+//End Class MrmsSource
@@ -0,0 +1,137 @@
+#ifndef MRMSSOURCE_H
+#define MRMSSOURCE_H
+
+#include <zlib.h>
+#include <vector>
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	File:		MrmsSource
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	Where a MRMS binary file's bytes come from: a file
+	            path, a buffer already in memory, an open file
+	            descriptor, or a callback that pulls bytes on
+	            demand (e.g. a message bus client).  gzip'd input
+	            (one or more members) is inflated as it is read;
+	            anything else is passed through as is.
+
+	            MrmsHeader::probe, MrmsGrid::read and
+	            MrmsSlabReader::open take a source as well as a
+	            path, and parse the header the same way for both.
+	            A name given with a source is used in error
+	            messages and as the feed for MrmsByteOrderCache.
+
+	            Buffers and callbacks are read from, never
+	            copied whole; the caller keeps a buffer alive
+	            until the source is closed.  A file descriptor is
+	            read from its current offset and left open.
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+// T Y P E S
+
+//Pull up to num_bytes into buf.  Returns the number of bytes
+//given (0 at the end of the input) or < 0 on error.
+typedef long (*MrmsPullFunc)(void *user, void *buf, size_t num_bytes);
+
+
+
+class MrmsSource
+{
+  public:
+
+    //default constructor
+    MrmsSource();
+
+    //destructor
+    ~MrmsSource();
+
+    //non-copyable
+    MrmsSource(const MrmsSource& source) = delete;
+    MrmsSource& operator= (const MrmsSource& source) = delete;
+
+
+    //public methods
+    int open(const char *vfname);
+    int open(const void *buf, size_t num_bytes, const char *name = "buffer");
+    int open(int fd, const char *name = "fd");
+    int open(MrmsPullFunc pull, void *user, const char *name = "stream");
+    void close();
+
+    long read(void *dest, size_t num_bytes);
+    int readAll(void *dest, size_t num_bytes);
+    int skip(size_t num_bytes);
+
+    bool isOpen() const { return (kind != NONE); }
+    const string& name() const { return sourceName; }
+    bool gzip() const { return gzipped; }
+
+    //file path, or 0 if the source is not a named file
+    const char* path() const
+      { return (kind == PATH) ? sourceName.c_str() : 0; }
+
+    //whole input in memory, or 0 if the source is not a buffer
+    const void* memory() const { return (kind == MEMORY) ? memBuf : 0; }
+    size_t memoryBytes() const { return (kind == MEMORY) ? memBytes : 0; }
+
+    //what the input says about the size of its (uncompressed)
+    //contents; canHold and matches are always true when the input
+    //size is unknown, matchesExactly is then false.  A gzip trailer's
+    //ISIZE is advisory (multi-member files) except to matchesExactly
+    bool canHold(size_t num_bytes) const;
+    bool matches(size_t num_bytes) const;
+    bool matchesExactly(size_t num_bytes) const;
+
+
+  private:
+
+    enum Kind { NONE, PATH, FD, MEMORY, PULL };
+
+    Kind kind;
+    string sourceName;
+    bool gzipped;
+
+    //input size: compressed bytes and the gzip trailer's ISIZE
+    bool sizeKnown;
+    size_t inputBytes;
+    size_t isize;
+
+    //PATH and FD read through zlib's gz functions
+    gzFile fpGzip;
+
+    //MEMORY and PULL: raw input, and the inflate state when gzip'd
+    const unsigned char *memBuf;
+    size_t memBytes;
+    MrmsPullFunc pullFunc;
+    void *pullUser;
+    vector<unsigned char> chunk;
+    const unsigned char *inPos;
+    size_t inLeft;
+    bool inEnd;
+    z_stream strm;
+    bool strmReady;
+    bool strmEnd;
+
+    void setSize(size_t input_bytes, const unsigned char *trailer);
+    int fill();
+    int fillMagic();
+    int startInput();
+    long readRaw(unsigned char *dest, size_t num_bytes);
+    long readInflate(unsigned char *dest, size_t num_bytes);
+
+};
+//end class MrmsSource
+
+#endif
@@ -0,0 +1,511 @@
+#include <string.h>
+#include <cstdlib>
+#include <fnmatch.h>
+
+#include "MrmsTarReader.h"
+
+using namespace std;
+
+
+// C O N S T A N T S
+
+//tar header and data block size
+static const size_t TAR_BLOCK = 512;
+
+
+
+// F U N C T I O N S
+
+/*------------------------------------------------------------------
+
+	Function:	tar_number
+
+	Purpose:	Value of a numeric tar header field: octal text,
+	            or big-endian base-256 when the first byte has its
+	            high bit set (GNU, for sizes of 8 GB and more)
+
+------------------------------------------------------------------*/
+
+static size_t tar_number(const unsigned char *field, size_t len)
+{
+    size_t value = 0;
+
+    if(field[0] & 0x80)
+    {
+      value = field[0] & 0x7f;
+      for(size_t i = 1; i < len; i++) value = (value << 8) | field[i];
+      return value;
+    }
+
+    size_t i = 0;
+    while( (i < len) && (field[i] == ' ') ) i++;
+
+    for( ; (i < len) && (field[i] >= '0') && (field[i] <= '7'); i++)
+      value = value*8 + (field[i] - '0');
+
+    return value;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	tar_string
+
+	Purpose:	Text of a tar header field, which is NUL-terminated
+	            unless it fills the field
+
+------------------------------------------------------------------*/
+
+static string tar_string(const unsigned char *field, size_t len)
+{
+    const char *text = reinterpret_cast< const char * >( field );
+
+    return string(text, strnlen(text, len));
+}
+
+
+
+/*****************************/
+/*****************************/
+/** C O N S T R U C T O R S **/
+/*****************************/
+
+//default constructor
+MrmsTarReader::MrmsTarReader()
+{
+    source = 0;
+    size = 0;
+    pending = 0;
+    loaded = false;
+    skipped = 0;
+}
+
+/************************************/
+/** E N D  C O N S T R U C T O R S **/
+/************************************/
+/************************************/
+
+
+
+/********************************/
+/********************************/
+/** P U B L I C  M E T H O D S **/
+/********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		open
+
+	Purpose:	Open a tar archive by name; gzip'd archives are
+	            inflated as they are read.  Any archive already
+	            open is closed first.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsTarReader::open(const char *vfname)
+{
+    close();
+    errorText.clear();
+
+    if(fileSource.open(vfname) < 0)
+    {
+      errorText = string("Could not open ") + vfname;
+      return -1;
+    }
+
+    source = &fileSource;
+    archiveName = vfname;
+
+    return 1;
+
+}//end public method MrmsTarReader::open
+
+
+/*------------------------------------------------------------------
+
+	Method:		open (source)
+
+	Purpose:	Read a tar archive from an open source (e.g. a
+	            pipe).  The source must stay open until close; it
+	            is not closed here.
+
+------------------------------------------------------------------*/
+
+int MrmsTarReader::open(MrmsSource &input)
+{
+    close();
+    errorText.clear();
+
+    if( !input.isOpen() )
+    {
+      errorText = "No source open";
+      return -1;
+    }
+
+    source = &input;
+    archiveName = input.name();
+
+    return 1;
+
+}//end public method MrmsTarReader::open (source)
+
+
+/*------------------------------------------------------------------
+
+	Method:		next
+
+	Purpose:	Move to the next regular file in the archive whose
+	            name matches the pattern.  Whatever is left of the
+	            current member is skipped.
+
+	Output:		int indicating a member was found (1), the end of
+	            the archive (0), or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsTarReader::next()
+{
+    if(source == 0)
+    {
+      errorText = "No archive open";
+      return -1;
+    }
+
+    errorText.clear();
+
+    if(skipData(pending) < 0) return -1;
+
+    name.clear();
+    size = 0;
+    pending = 0;
+    loaded = false;
+
+
+    //Long names (GNU 'L', pax path) and pax sizes apply to the
+    //header that follows them
+    string long_name;
+    size_t long_size = 0;
+    bool have_name = false, have_size = false;
+
+    while(true)
+    {
+      string member_name;
+      size_t member_size = 0;
+      char type = 0;
+
+      int status = readHeader(member_name, member_size, type);
+      if(status <= 0) return status;
+
+      size_t padded = (member_size + TAR_BLOCK-1) / TAR_BLOCK * TAR_BLOCK;
+
+      if(type == 'L')
+      {
+        if( (readText(member_size, long_name) < 0) ||
+            (skipData(padded - member_size) < 0) ) return -1;
+
+        have_name = true;
+        continue;
+      }
+
+      if(type == 'x')
+      {
+        string records;
+        if( (readText(member_size, records) < 0) ||
+            (skipData(padded - member_size) < 0) ) return -1;
+
+        //records are "<length> <key>=<value>\n"
+        size_t pos = 0;
+        while(pos < records.size())
+        {
+          size_t length = strtoul(records.c_str() + pos, 0, 10);
+          size_t space = records.find(' ', pos);
+          if( (length == 0) || (space == string::npos) ||
+              (pos + length > records.size()) ) break;
+
+          string record = records.substr(space+1, pos + length - space - 2);
+          size_t equals = record.find('=');
+
+          if(equals != string::npos)
+          {
+            string key = record.substr(0, equals);
+            string value = record.substr(equals+1);
+
+            if(key == "path")
+            {
+              long_name = value;
+              have_name = true;
+            }
+            else if(key == "size")
+            {
+              long_size = strtoull(value.c_str(), 0, 10);
+              have_size = true;
+            }
+          }
+
+          pos += length;
+        }
+
+        continue;
+      }
+
+      if(have_name) member_name = long_name;
+      if(have_size) member_size = long_size;
+      padded = (member_size + TAR_BLOCK-1) / TAR_BLOCK * TAR_BLOCK;
+      have_name = have_size = false;
+
+      bool regular = (type == '0') || (type == '\0') || (type == '7');
+
+      if( !regular || ( !namePattern.empty() &&
+          (fnmatch(namePattern.c_str(), member_name.c_str(), 0) != 0) ) )
+      {
+        skipped++;
+        if(skipData(padded) < 0) return -1;
+        continue;
+      }
+
+      name = member_name;
+      size = member_size;
+      pending = padded;
+
+      return 1;
+    }
+
+}//end public method MrmsTarReader::next
+
+
+/*------------------------------------------------------------------
+
+	Method:		member
+
+	Purpose:	The current member's bytes as a source, positioned
+	            at its first byte.  The member is read from the
+	            archive on the first call.  The source is valid
+	            until the next call to member, next or close.
+
+	Output:		MrmsSource* (0 on failure; see errorMessage)
+
+------------------------------------------------------------------*/
+
+MrmsSource* MrmsTarReader::member()
+{
+    if( (source == 0) || name.empty() )
+    {
+      errorText = "No archive member to read";
+      return 0;
+    }
+
+    if( !loaded )
+    {
+      bytes.resize(size);
+
+      if( (size > 0) && (source->readAll(bytes.data(), size) < 0) )
+      {
+        errorText = "Truncated member " + name + " in " + archiveName;
+        return 0;
+      }
+
+      pending -= size;
+      loaded = true;
+    }
+
+    if( (size == 0) ||
+        (memberSource.open(bytes.data(), size, (archiveName + "/" + name).c_str()) < 0) )
+    {
+      errorText = "Could not read member " + name + " in " + archiveName;
+      return 0;
+    }
+
+    return &memberSource;
+
+}//end public method MrmsTarReader::member
+
+
+/*------------------------------------------------------------------
+
+	Method:		close
+
+	Purpose:	Close the archive (a caller's source is left open).
+	            The member buffer is kept for reuse.
+
+------------------------------------------------------------------*/
+
+void MrmsTarReader::close()
+{
+    memberSource.close();
+    fileSource.close();
+    source = 0;
+
+    archiveName.clear();
+    name.clear();
+    size = 0;
+    pending = 0;
+    loaded = false;
+    skipped = 0;
+
+}//end public method MrmsTarReader::close
+
+
+/*------------------------------------------------------------------
+
+	Method:		isArchiveName
+
+	Purpose:	True if the file name looks like a tar archive
+	            (.tar, .tar.gz or .tgz)
+
+------------------------------------------------------------------*/
+
+bool MrmsTarReader::isArchiveName(const string &vfname)
+{
+    const char *suffixes[] = { ".tar", ".tar.gz", ".tgz" };
+
+    for(size_t s = 0; s < 3; s++)
+    {
+      size_t len = strlen(suffixes[s]);
+
+      if( (vfname.size() > len) &&
+          (vfname.compare(vfname.size()-len, len, suffixes[s]) == 0) )
+        return true;
+    }
+
+    return false;
+
+}//end public method MrmsTarReader::isArchiveName
+
+/***************************************/
+/** E N D  P U B L I C  M E T H O D S **/
+/***************************************/
+/***************************************/
+
+
+
+/**********************************/
+/**********************************/
+/** P R I V A T E  M E T H O D S **/
+/**********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		readHeader
+
+	Purpose:	Read and check the next 512-byte header block
+
+	Output:		member_name, member_size, type = header fields
+	            int indicating a header was read (1), the end of
+	            the archive (0; a zero block or end of input), or
+	            failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsTarReader::readHeader(string &member_name, size_t &member_size,
+                              char &type)
+{
+    unsigned char block[TAR_BLOCK];
+
+    long num_read = source->read(block, TAR_BLOCK);
+    if(num_read == 0) return 0;
+
+    if(num_read != (long)TAR_BLOCK)
+    {
+      errorText = "Truncated tar header in " + archiveName;
+      return -1;
+    }
+
+
+    //End of archive: a block of zeros
+    size_t sum = 0;
+    bool zero = true;
+
+    for(size_t i = 0; i < TAR_BLOCK; i++)
+    {
+      if(block[i] != 0) zero = false;
+      sum += ( (i >= 148) && (i < 156) ) ? ' ' : block[i];
+    }
+
+    if(zero) return 0;
+
+    if( sum != tar_number(block+148, 8) )
+    {
+      errorText = "Bad tar header checksum in " + archiveName
+                + " (not a tar archive?)";
+      return -1;
+    }
+
+
+    //Fields
+    member_name = tar_string(block, 100);
+    member_size = tar_number(block+124, 12);
+    type = (char)block[156];
+
+    //ustar: the name may continue in the prefix field
+    if( memcmp(block+257, "ustar", 5) == 0 )
+    {
+      string prefix = tar_string(block+345, 155);
+      if( !prefix.empty() ) member_name = prefix + "/" + member_name;
+    }
+
+    return 1;
+
+}//end private method MrmsTarReader::readHeader
+
+
+/*------------------------------------------------------------------
+
+	Method:		readText
+
+	Purpose:	Read num_bytes of member data as text (long names
+	            and pax records), up to the first NUL
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsTarReader::readText(size_t num_bytes, string &text)
+{
+    text.assign(num_bytes, '\0');
+
+    if( (num_bytes > 0) && (source->readAll(&text[0], num_bytes) < 0) )
+    {
+      errorText = "Truncated tar header in " + archiveName;
+      return -1;
+    }
+
+    size_t end = text.find('\0');
+    if(end != string::npos) text.resize(end);
+
+    return 1;
+
+}//end private method MrmsTarReader::readText
+
+
+/*------------------------------------------------------------------
+
+	Method:		skipData
+
+	Purpose:	Pass over num_bytes of the archive
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsTarReader::skipData(size_t num_bytes)
+{
+    if(num_bytes == 0) return 1;
+
+    if(source->skip(num_bytes) < 0)
+    {
+      errorText = "Truncated archive " + archiveName;
+      return -1;
+    }
+
+    return 1;
+
+}//end private method MrmsTarReader::skipData
+
+/*****************************************/
+/** E N D  P R I V A T E  M E T H O D S **/
+/*****************************************/
+/*****************************************/
+
+//End Class MrmsTarReader
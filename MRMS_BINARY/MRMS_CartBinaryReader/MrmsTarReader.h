@@ -0,0 +1,113 @@
+#ifndef MRMSTARREADER_H
+#define MRMSTARREADER_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+#include "MrmsSource.h"
+
+using namespace std;
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	File:		MrmsTarReader
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	Walks the members of a tar archive (.tar, or a
+	            gzip'd .tar.gz/.tgz) in one sequential read, so
+	            archived MRMS binaries can be decoded without
+	            extracting them.
+
+	            next() moves to the next regular file whose name
+	            matches the pattern (setPattern; fnmatch rules,
+	            "*" also matching "/").  Members that do not match
+	            are skipped without being copied.  member() then
+	            gives the member's bytes as an MrmsSource, to
+	            hand to MrmsHeader::probe, MrmsGrid::read or
+	            MrmsSlabReader::open.  Each call to member()
+	            starts again at the member's first byte, so a
+	            member can be probed first and read after.
+
+	            ustar and old-style headers are read, along with
+	            GNU long names and pax path/size records.  The
+	            member's bytes are held in one buffer, reused
+	            from member to member, until next() is called.
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+class MrmsTarReader
+{
+  public:
+
+    //default constructor
+    MrmsTarReader();
+
+    //non-copyable
+    MrmsTarReader(const MrmsTarReader& reader) = delete;
+    MrmsTarReader& operator= (const MrmsTarReader& reader) = delete;
+
+
+    //public methods
+    int open(const char *vfname);
+    int open(MrmsSource &source);
+    int next();
+    void close();
+
+    void setPattern(const string &glob) { namePattern = glob; }
+    const string& pattern() const { return namePattern; }
+
+    //current member: name in the archive, size, and its bytes
+    //(0 on failure; see errorMessage)
+    const string& memberName() const { return name; }
+    size_t memberSize() const { return size; }
+    MrmsSource* member();
+
+    //members passed over by next() so far (not regular files, or
+    //not matching the pattern)
+    size_t numSkipped() const { return skipped; }
+
+    //why the last open, next or member failed
+    const string& errorMessage() const { return errorText; }
+
+    static bool isArchiveName(const string &vfname);
+
+
+  private:
+
+    //archive being read: the caller's, or fileSource when opened
+    //by name (0 = none)
+    MrmsSource *source;
+    MrmsSource fileSource;
+    string archiveName;
+
+    string namePattern;
+
+    //current member, and archive bytes still to pass before the
+    //next header
+    string name;
+    size_t size;
+    size_t pending;
+    bool loaded;
+    size_t skipped;
+
+    vector<unsigned char> bytes;
+    MrmsSource memberSource;
+
+    string errorText;
+
+    int readHeader(string &member_name, size_t &member_size, char &type);
+    int readText(size_t num_bytes, string &text);
+    int skipData(size_t num_bytes);
+
+};
+//end class MrmsTarReader
+
+#endif
@@ -0,0 +1,197 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "mrms_binary_reader.h"
+#include "mrms_byteswap.h"
+
+using namespace std;
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	Program:	bench_byteswap.cc
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	Microbenchmark of the int16 byte swap kernels
+	            (mrms_byteswap) against the per-value byteswap
+	            template of mrms_binary_reader.h and the loop it
+	            replaced (a new/delete per value), on an array the
+	            size of a CONUS level (7000 x 3500) or of the
+	            given number of values.  Every kernel's output is
+	            first checked against the template's; the program
+	            exits with 1 if any differs.
+
+	            Kernels the CPU lacks are reported and skipped.
+
+	Input:		optional: number of int16 values (default
+	            24500000) and number of repetitions (default 10)
+
+	Output: 	Milliseconds per swap and GB/s for each kernel
+
+	To Compile:	make bench
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+
+typedef void (*SwapKernel)(short int *data, size_t num_elements);
+
+
+/*------------------------------------------------------------------
+
+	Function:	template_swap
+
+	Purpose:	The reference: byteswap() one value at a time
+
+------------------------------------------------------------------*/
+
+static void template_swap(short int *data, size_t num_elements)
+{
+    for(size_t i = 0; i < num_elements; i++)
+      byteswap(data[i]);
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	heap_loop_swap
+
+	Purpose:	The original array byteswap: each value swapped
+	            through a temporary allocated with new[]
+
+------------------------------------------------------------------*/
+
+static void heap_loop_swap(short int *data, size_t num_elements)
+{
+    int num_bytes = sizeof(short int);
+
+    for(size_t i = 0; i < num_elements; i++)
+    {
+      char *temp = new char[num_bytes];
+      char *char_data = reinterpret_cast< char * >( &data[i] );
+
+      for(int b = 0; b < num_bytes; b++) temp[b] = char_data[num_bytes-b-1];
+      for(int b = 0; b < num_bytes; b++) char_data[b] = temp[b];
+
+      delete [] temp;
+    }
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	kernel_available
+
+	Purpose:	True if the CPU can run the named kernel
+
+------------------------------------------------------------------*/
+
+static bool kernel_available(const string &name)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if(name == "avx2") return __builtin_cpu_supports("avx2");
+    if(name == "sse2") return __builtin_cpu_supports("sse2");
+#else
+    if( (name == "avx2") || (name == "sse2") ) return false;
+#endif
+
+    return true;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	time_kernel
+
+	Purpose:	Average time of one swap of data by kernel, over
+	            num_reps repetitions
+
+	Output:		seconds
+
+------------------------------------------------------------------*/
+
+static double time_kernel(SwapKernel kernel, vector<short int> &data,
+                          int num_reps)
+{
+    kernel(data.data(), data.size());   //warm up
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    for(int r = 0; r < num_reps; r++)
+      kernel(data.data(), data.size());
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    return elapsed.count() / num_reps;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+    size_t num_values = (argc > 1) ? strtoul(argv[1], 0, 10) : 24500000;
+    int num_reps = (argc > 2) ? atoi(argv[2]) : 10;
+
+    if( (num_values == 0) || (num_reps < 1) )
+    {
+      cout<<"Usage:  bench_byteswap [num_values [num_reps]]"<<endl;
+      exit(1);
+    }
+
+    struct Kernel { const char *name; SwapKernel swap; };
+    Kernel kernels[] = {
+      { "old loop", heap_loop_swap },
+      { "template", template_swap },
+      { "scalar",   byteswap_int16_scalar },
+      { "sse2",     byteswap_int16_sse2 },
+      { "avx2",     byteswap_int16_avx2 },
+      { "dispatch", byteswap_int16 } };
+    int num_kernels = sizeof(kernels)/sizeof(kernels[0]);
+
+
+    //odd length so every kernel's tail is checked
+    vector<short int> input(num_values | 1);
+    for(size_t i = 0; i < input.size(); i++)
+      input[i] = (short int)(i*2654435761UL >> 7);
+
+    vector<short int> expected = input;
+    template_swap(expected.data(), expected.size());
+
+    int status = 0;
+    printf("%zu values, %d repetitions; dispatch uses %s\n",
+           input.size(), num_reps, byteswap_int16_kernel());
+
+    for(int k = 0; k < num_kernels; k++)
+    {
+      if( !kernel_available(kernels[k].name) )
+      {
+        printf("%-10s not supported by this CPU\n", kernels[k].name);
+        continue;
+      }
+
+      vector<short int> data = input;
+      kernels[k].swap(data.data(), data.size());
+      if(data != expected)
+      {
+        printf("%-10s WRONG RESULT\n", kernels[k].name);
+        status = 1;
+        continue;
+      }
+
+      double seconds = time_kernel(kernels[k].swap, data, num_reps);
+      printf("%-10s %8.2f ms  %6.2f GB/s\n", kernels[k].name, seconds*1e3,
+             (double)data.size()*sizeof(short int) / seconds / 1e9);
+    }
+
+    return status;
+
+}//end main function
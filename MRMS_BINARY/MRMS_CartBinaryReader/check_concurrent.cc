@@ -0,0 +1,545 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "mrms_binary_reader.h"
+#include "MrmsGzIndex.h"
+
+using namespace std;
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	Program:	check_concurrent.cc
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	Stress test of the reader from several threads.
+	            A set of synthetic MRMS binary files is written to
+	            a scratch directory: 2D and 3D grids, both byte
+	            orders, plain and gzip'd, a multi-member gzip file,
+	            one with a random-access index (inflated in
+	            parallel) and a truncated one.  Each file is first
+	            decoded serially, whole (MrmsGrid) and a few rows
+	            at a time (MrmsSlabReader).  Then N threads decode
+	            all of them repeatedly, each starting at a
+	            different file so the same and different files are
+	            read at once, sharing one byte order cache and one
+	            buffer pool.  Every result (header, epoch seconds,
+	            CRC of the data, error message) must match the
+	            serial one.
+
+	            Each file is also read through a pull callback that
+	            gives one byte at a time, so gzip member boundaries
+	            (and their magic numbers) are split across pulls;
+	            it must match the serial result too.
+
+	            Epoch seconds from the header (days_from_civil)
+	            are also checked against timegm.
+
+	Input:		optional: number of threads (default 8) and
+	            passes over the files per thread (default 4)
+
+	Output: 	Summary line; exit status 1 on any mismatch
+
+	To Compile:	make check (builds and runs it)
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+
+//one synthetic input file
+struct TestFile
+{
+    string name;
+    int nx, ny, nz;
+    int year, month, day, hour, minute, second;
+    bool bigEndian;
+    int gzipMembers;      //0 = plain
+    bool indexed;
+    bool truncated;
+};
+
+//what one decode gave
+struct Decoded
+{
+    int status;
+    string error;
+    string varName;
+    int nx, ny, nz, swapFlag;
+    time_t epochSeconds;
+    size_t numValues;
+    unsigned long crc;
+
+    bool operator== (const Decoded &d) const
+    {
+      return (status == d.status) && (error == d.error) &&
+             (varName == d.varName) && (nx == d.nx) && (ny == d.ny) &&
+             (nz == d.nz) && (swapFlag == d.swapFlag) &&
+             (epochSeconds == d.epochSeconds) &&
+             (numValues == d.numValues) && (crc == d.crc);
+    }
+};
+
+
+/*------------------------------------------------------------------
+
+	Function:	put_int, put_text
+
+	Purpose:	Append a 4-byte int in the given byte order, or
+	            text padded with zeros to num_bytes
+
+------------------------------------------------------------------*/
+
+static void put_int(vector<unsigned char> &buf, int value, bool big_endian)
+{
+    unsigned int u = (unsigned int)value;
+
+    for(int b = 0; b < 4; b++)
+    {
+      int shift = big_endian ? 8*(3-b) : 8*b;
+      buf.push_back( (unsigned char)((u >> shift) & 0xff) );
+    }
+}
+
+
+static void put_text(vector<unsigned char> &buf, const char *text,
+                     size_t num_bytes)
+{
+    size_t len = strlen(text);
+
+    for(size_t b = 0; b < num_bytes; b++)
+      buf.push_back( (b < len) ? (unsigned char)text[b] : 0 );
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	write_test_file
+
+	Purpose:	Write one synthetic MRMS binary file (see the
+	            format document), gzip'd in tf.gzipMembers members
+	            (0 = plain), and index or truncate it as asked
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+static int write_test_file(const TestFile &tf)
+{
+    bool be = tf.bigEndian;
+    vector<unsigned char> buf;
+
+    put_int(buf, tf.year, be);   put_int(buf, tf.month, be);
+    put_int(buf, tf.day, be);    put_int(buf, tf.hour, be);
+    put_int(buf, tf.minute, be); put_int(buf, tf.second, be);
+    put_int(buf, tf.nx, be);     put_int(buf, tf.ny, be);
+    put_int(buf, tf.nz, be);
+    put_text(buf, "LL", 4);
+    put_int(buf, 1000, be);                              //map scale
+    for(int i = 0; i < 3; i++) put_int(buf, 0, be);      //trulats, trulon
+    put_int(buf, -130000, be);   put_int(buf, 55000, be);  //NW lon, lat
+    put_int(buf, 0, be);                                 //xy scale
+    put_int(buf, 10, be);        put_int(buf, 10, be);   //dx, dy
+    put_int(buf, 1000, be);                              //dxy scale
+    for(int k = 0; k < tf.nz; k++) put_int(buf, 500*(k+1), be);
+    put_int(buf, 1, be);                                 //z scale
+    for(int i = 0; i < 10; i++) put_int(buf, 0, be);     //placeholders
+    put_text(buf, (tf.nz > 1) ? "MREF" : "CREF", 20);
+    put_text(buf, "dBZ", 6);
+    put_int(buf, 10, be);        put_int(buf, -99, be);  //scale, missing
+    put_int(buf, 2, be);                                 //radars
+    put_text(buf, "KTLX", 4);    put_text(buf, "KINX", 4);
+
+    size_t num_values = (size_t)tf.nx*tf.ny*tf.nz;
+    for(size_t i = 0; i < num_values; i++)
+    {
+      int value = (i % 13 == 0) ? -990 : (int)((i*7 + tf.nx) % 1500) - 300;
+      int hi = (value >> 8) & 0xff, lo = value & 0xff;
+
+      buf.push_back( (unsigned char)(be ? hi : lo) );
+      buf.push_back( (unsigned char)(be ? lo : hi) );
+    }
+
+    if(tf.truncated) buf.resize(buf.size() - 1000);
+
+
+    if(tf.gzipMembers == 0)
+    {
+      FILE *fp = fopen(tf.name.c_str(), "wb");
+      if(fp == 0) return -1;
+
+      size_t num_written = fwrite(buf.data(), 1, buf.size(), fp);
+      if( (fclose(fp) != 0) || (num_written != buf.size()) ) return -1;
+
+      return 1;
+    }
+
+    //each member is appended as a new gzip stream
+    unlink(tf.name.c_str());
+    size_t member_bytes = buf.size()/tf.gzipMembers + 1;
+
+    for(size_t start = 0; start < buf.size(); start += member_bytes)
+    {
+      size_t len = (start + member_bytes <= buf.size()) ? member_bytes :
+                                                          buf.size() - start;
+
+      gzFile gz = gzopen(tf.name.c_str(), "ab");
+      if(gz == 0) return -1;
+
+      int num_written = gzwrite(gz, &buf[start], (unsigned int)len);
+      if( (gzclose(gz) != Z_OK) || (num_written != (int)len) ) return -1;
+    }
+
+    if(tf.indexed)
+    {
+      MrmsGzIndex index;
+      if( (index.build(tf.name.c_str(), 65536) < 0) || (index.save() < 0) )
+        return -1;
+    }
+
+    return 1;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	decode
+
+	Purpose:	Read one file whole (MrmsGrid, on 2 threads when
+	            it has an index) or a few rows at a time
+	            (MrmsSlabReader), detecting its byte order
+
+	Output:		what was read, or the error
+
+------------------------------------------------------------------*/
+
+static Decoded decode(const string &vfname, bool slabs,
+                      MrmsByteOrderCache *byte_orders, MrmsBufferPool *pool)
+{
+    Decoded d;
+    d.status = 1;
+    d.nx = d.ny = d.nz = d.swapFlag = 0;
+    d.epochSeconds = 0;
+    d.numValues = 0;
+    d.crc = crc32(0L, Z_NULL, 0);
+
+    const MrmsHeader *hdr = 0;
+    MrmsGrid grid;
+    MrmsSlabReader reader;
+
+    if(!slabs)
+    {
+      grid.setBufferPool(pool);
+      grid.setThreads(2);
+
+      d.status = grid.read(vfname.c_str(), MRMS_SWAP_AUTO, byte_orders);
+      if(d.status < 0)
+      {
+        d.error = grid.errorMessage();
+        return d;
+      }
+
+      hdr = &grid.header();
+      d.numValues = grid.size();
+      d.crc = crc32(d.crc, (const Bytef *)grid.data(),
+                    (uInt)(grid.size()*sizeof(short int)));
+    }
+    else
+    {
+      reader.setBufferPool(pool);
+
+      d.status = reader.open(vfname.c_str(), MRMS_SWAP_AUTO, byte_orders);
+
+      int next_status = 0;
+      while( (d.status > 0) && ((next_status = reader.next(7)) > 0) )
+      {
+        d.numValues += reader.size();
+        d.crc = crc32(d.crc, (const Bytef *)reader.data(),
+                      (uInt)(reader.size()*sizeof(short int)));
+      }
+
+      if( (d.status < 0) || (next_status < 0) )
+      {
+        d.status = -1;
+        d.error = reader.errorMessage();
+        return d;
+      }
+
+      hdr = &reader.header();
+    }
+
+    d.varName = hdr->varName;
+    d.nx = hdr->nx;
+    d.ny = hdr->ny;
+    d.nz = hdr->nz;
+    d.swapFlag = hdr->swapFlag;
+    d.epochSeconds = hdr->epochSeconds;
+
+    return d;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	pull_one_byte
+
+	Purpose:	MrmsPullFunc over a PullInput that gives at most
+	            one byte per call
+
+------------------------------------------------------------------*/
+
+struct PullInput
+{
+    vector<unsigned char> bytes;
+    size_t pos;
+};
+
+static long pull_one_byte(void *user, void *buf, size_t num_bytes)
+{
+    PullInput *input = static_cast< PullInput * >( user );
+
+    if( (num_bytes == 0) || (input->pos >= input->bytes.size()) ) return 0;
+
+    *static_cast< unsigned char * >( buf ) = input->bytes[input->pos++];
+
+    return 1;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	decode_pulled
+
+	Purpose:	Read one file whole (MrmsGrid) through pull_one_byte
+
+	Output:		what was read, or the error (-1 status and an
+	            empty message if the file cannot be loaded)
+
+------------------------------------------------------------------*/
+
+static Decoded decode_pulled(const string &vfname)
+{
+    Decoded d;
+    d.status = -1;
+    d.nx = d.ny = d.nz = d.swapFlag = 0;
+    d.epochSeconds = 0;
+    d.numValues = 0;
+    d.crc = crc32(0L, Z_NULL, 0);
+
+    PullInput input;
+    input.pos = 0;
+
+    FILE *fp = fopen(vfname.c_str(), "rb");
+    if(fp == 0) return d;
+
+    unsigned char block[65536];
+    size_t num_read;
+    while( (num_read = fread(block, 1, sizeof(block), fp)) > 0 )
+      input.bytes.insert(input.bytes.end(), block, block + num_read);
+    fclose(fp);
+
+    MrmsSource source;
+    if( source.open(pull_one_byte, &input, vfname.c_str()) < 0 ) return d;
+
+    MrmsGrid grid;
+    d.status = grid.read(source, MRMS_SWAP_AUTO);
+    if(d.status < 0)
+    {
+      d.error = grid.errorMessage();
+      return d;
+    }
+
+    const MrmsHeader &hdr = grid.header();
+    d.numValues = grid.size();
+    d.crc = crc32(d.crc, (const Bytef *)grid.data(),
+                  (uInt)(grid.size()*sizeof(short int)));
+    d.varName = hdr.varName;
+    d.nx = hdr.nx;
+    d.ny = hdr.ny;
+    d.nz = hdr.nz;
+    d.swapFlag = hdr.swapFlag;
+    d.epochSeconds = hdr.epochSeconds;
+
+    return d;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	check_epochs
+
+	Purpose:	Compare days_from_civil with timegm over 1900-2199
+
+	Output:		number of dates that differ
+
+------------------------------------------------------------------*/
+
+static long check_epochs()
+{
+    long num_bad = 0;
+
+    for(int year = 1900; year < 2200; year++)
+      for(int month = 1; month <= 12; month++)
+        for(int day = 1; day <= 28; day += 3)
+        {
+          struct tm tm_utc;
+          memset(&tm_utc, 0, sizeof(tm_utc));
+          tm_utc.tm_year = year - 1900;
+          tm_utc.tm_mon = month - 1;
+          tm_utc.tm_mday = day;
+
+          if( (time_t)(days_from_civil(year, month, day)*86400L) !=
+              timegm(&tm_utc) )
+            num_bad++;
+        }
+
+    return num_bad;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+    int num_threads = (argc > 1) ? atoi(argv[1]) : 8;
+    int num_passes = (argc > 2) ? atoi(argv[2]) : 4;
+
+    if( (num_threads < 1) || (num_passes < 1) )
+    {
+      cout<<"Usage:  check_concurrent [num_threads [num_passes]]"<<endl;
+      exit(1);
+    }
+
+    long epoch_bad = check_epochs();
+    printf("epoch seconds vs timegm: %ld wrong\n", epoch_bad);
+
+
+    //Write the test files
+    char dir_template[] = "/tmp/check_concurrent.XXXXXX";
+    if(mkdtemp(dir_template) == 0)
+    {
+      cout<<"+++ERROR: Could not make a scratch directory"<<endl;
+      exit(1);
+    }
+    string dir = dir_template;
+
+    //name, nx, ny, nz, date and time, big endian, gzip members,
+    //indexed, truncated
+    TestFile files[] = {
+      { "2d_le.gz",       700, 350,  1, 2023,  7, 14, 18, 32,  0, false, 1, false, false },
+      { "2d_be.gz",       640, 480,  1, 1999, 12, 31, 23, 59, 59, true,  1, false, false },
+      { "3d_le.gz",       300, 200, 12, 2024,  2, 29, 12,  0,  0, false, 1, false, false },
+      { "3d_be.bin",      250, 150,  6, 2031,  3,  1,  0,  0,  1, true,  0, false, false },
+      { "3d_multi.gz",    320, 240,  8, 2016,  6, 30, 23, 59, 59, false, 3, false, false },
+      { "3d_indexed.gz",  400, 300, 10, 2025, 10, 17,  6, 30, 30, false, 1, true,  false },
+      { "3d_trunc.gz",    200, 100,  5, 2023,  1,  1,  0,  0,  0, false, 1, false, true  } };
+    int num_files = sizeof(files)/sizeof(files[0]);
+
+    vector<string> names;
+    for(int f = 0; f < num_files; f++)
+    {
+      files[f].name = dir + "/" + files[f].name;
+      names.push_back(files[f].name);
+
+      if( write_test_file(files[f]) < 0 )
+      {
+        cout<<"+++ERROR: Could not write "<<files[f].name<<endl;
+        exit(1);
+      }
+    }
+
+
+    //Serial results: whole, then by slabs, for each file
+    vector<Decoded> serial;
+    for(int f = 0; f < num_files; f++)
+      for(int slabs = 0; slabs < 2; slabs++)
+        serial.push_back( decode(names[f], slabs == 1, 0, 0) );
+
+    long serial_bad = 0;
+    for(int f = 0; f < num_files; f++)
+    {
+      const Decoded &d = serial[2*f];
+      bool want_ok = !files[f].truncated;
+
+      if( (d.status > 0) != want_ok ) serial_bad++;
+      if( (serial[2*f+1].status > 0) != want_ok ) serial_bad++;
+
+      //both ways must give the same grid
+      if( want_ok && !(serial[2*f+1] == d) ) serial_bad++;
+    }
+
+
+    //One byte per pull
+    long pulled_bad = 0;
+    for(int f = 0; f < num_files; f++)
+    {
+      Decoded d = decode_pulled(names[f]);
+      bool ok = files[f].truncated ? (d.status < 0) : (d == serial[2*f]);
+
+      if(!ok)
+      {
+        printf("%s read a byte per pull: %s\n", names[f].c_str(),
+               (d.status < 0) ? d.error.c_str() : "differs from serial");
+        pulled_bad++;
+      }
+    }
+
+
+    //Concurrent results
+    MrmsByteOrderCache byte_orders;
+    MrmsBufferPool pool;
+    vector<long> thread_bad(num_threads, 0);
+    vector<thread> threads;
+
+    for(int t = 0; t < num_threads; t++)
+    {
+      threads.push_back( thread( [&, t]()
+      {
+        for(int pass = 0; pass < num_passes; pass++)
+          for(int i = 0; i < 2*num_files; i++)
+          {
+            int which = (i + 2*t + pass) % (2*num_files);
+            Decoded d = decode(names[which/2], (which % 2) == 1,
+                               &byte_orders, &pool);
+
+            if( !(d == serial[which]) ) thread_bad[t]++;
+          }
+      } ) );
+    }
+
+    long concurrent_bad = 0;
+    for(int t = 0; t < num_threads; t++)
+    {
+      threads[t].join();
+      concurrent_bad += thread_bad[t];
+    }
+
+
+    //Clean up
+    for(int f = 0; f < num_files; f++)
+    {
+      unlink(names[f].c_str());
+      unlink(MrmsGzIndex::sidecarName(names[f].c_str()).c_str());
+    }
+    rmdir(dir.c_str());
+
+    printf("%d files: %ld serial errors, %ld wrong a byte per pull; "
+           "%d threads x %d passes (%d decodes): %ld differ from serial\n",
+           num_files, serial_bad, pulled_bad, num_threads, num_passes,
+           num_threads*num_passes*2*num_files, concurrent_bad);
+
+    return ( (epoch_bad > 0) || (serial_bad > 0) || (pulled_bad > 0) ||
+             (concurrent_bad > 0) ) ? 1 : 0;
+
+}//end main function
@@ -0,0 +1,155 @@
+#include <iostream>
+#include <fstream>
+#include <zlib.h>
+#include <vector>
+#include <string>
+#include <string.h>
+#include <ctime>
+
+#include "mrms_binary_reader.h"
+
+using namespace std;
+
+
+/*------------------------------------------------------------------
+
+	Function:	days_from_civil
+		
+	Purpose:	Days since Jan. 1, 1970 of a (proleptic Gregorian)
+	            date, in constant time.  After H. Hinnant's
+	            "chrono-Compatible Low-Level Date Algorithms".
+				
+	Input:		year, month (1-12), day (1-31)
+					
+	Output:		long storing days (negative before 1970)
+	
+------------------------------------------------------------------*/
+long days_from_civil(long year, int month, int day)
+{
+    year -= (month <= 2);
+
+    long era = ( (year >= 0) ? year : year-399 ) / 400;
+    long year_of_era = year - era*400;                        // [0, 399]
+    long day_of_year = (153*(month + ((month > 2) ? -3 : 9)) + 2)/5
+                     + day - 1;                               // [0, 365]
+    long day_of_era = year_of_era*365 + year_of_era/4 - year_of_era/100
+                    + day_of_year;                            // [0, 146096]
+
+    return era*146097 + day_of_era - 719468;
+}
+
+
+
+/*------------------------------------------------------------------
+
+	Function:	make_time
+		
+	Purpose:	Compute epoch seconds for a given time (UTC).
+	            Constant time; tim is not changed.
+				
+	Input:		tim = pointer to struct tm 
+					
+	Output:		time_t storing epoch seconds
+	
+------------------------------------------------------------------*/
+time_t make_time(struct tm *tim)
+{
+    long days = days_from_civil(tim->tm_year + 1900L, tim->tm_mon + 1,
+                                tim->tm_mday);
+
+    return (time_t)( days*86400L + tim->tm_hour*3600L
+                   + tim->tm_min*60L + tim->tm_sec );
+}
+
+
+
+/*------------------------------------------------------------------
+
+	Function: mrms_binary_reader_cart3d
+		
+	Purpose:  Read a MRMS Cartesian binary file and return
+              its header info and data.  Kept for existing
+              callers; new code should use MrmsGrid directly.
+
+              varname and varunit must hold at least 20 and 6
+              chars, and zhgt must hold nz values.  The caller
+              frees the returned array with delete [].
+				
+	Input:    vfname = input file name and path
+	
+              swap_flag = flag (= 0 or 1) indicating if values
+                          read from the file should be byte 
+                          swapped
+                
+                
+	Output:   varname = Name of variable
+	          varunit = Units of variable
+	
+	          nradars = Number of radars used in product
+	          radarnam = List of radars used in product
+	
+	          var_scale = Value used to scale the variable data	
+	          missing_val = Value to indicate missing data
+	
+	          nw_lon = Longitude of NW grid cell (center of cell)
+	          nw_lat = Latitude of NW grid cell (center of cell)
+	          
+	          nx = Number of columns in field
+	          ny = Number of rows in field
+	          dx = Size of grid cell (degrees longitude)
+	          dy = Size of grid cell (degrees latitude)
+	          
+	          zhgt = Height of vertical levels
+	          nz = Number of vertical levels
+	          
+	          epoch_seconds = valid time for file expressed in 
+	            epoch time (seconds since Jan. 1, 1970 00:00:00 UTC)
+	            
+	          binary_data = Variable data (scaled) in 1D array
+	
+------------------------------------------------------------------*/
+short int* mrms_binary_reader_cart3d(const char *vfname,                     
+                     char *varname, char *varunit,
+                     int &nradars, vector<string> &radarnam,
+                     int &var_scale, int &missing_val,
+                     float &nw_lon, float &nw_lat,
+                     int &nx, int &ny, float &dx, float &dy,
+                     float zhgt[], int &nz, long &epoch_seconds,
+                     int swap_flag)
+
+{
+    MrmsGrid grid;
+
+    if(grid.read(vfname, swap_flag) < 0)
+    {
+      cout<<"+++ERROR: "<<grid.errorMessage()<<endl;
+      return 0;
+    }
+
+    const MrmsHeader &hdr = grid.header();
+
+    strcpy(varname, hdr.varName.c_str());
+    strcpy(varunit, hdr.varUnit.c_str());
+
+    nradars = hdr.nradars;
+    radarnam.insert(radarnam.end(), hdr.radarNames.begin(), hdr.radarNames.end());
+
+    var_scale = hdr.varScale;
+    missing_val = hdr.missingVal;
+
+    nw_lon = hdr.nwLon;
+    nw_lat = hdr.nwLat;
+
+    nx = hdr.nx;
+    ny = hdr.ny;
+    dx = hdr.dx;
+    dy = hdr.dy;
+
+    nz = hdr.nz;
+    for(int k = 0; k < nz; k++) zhgt[k] = hdr.zhgt[k];
+
+    epoch_seconds = hdr.epochSeconds;
+
+    return grid.release();
+
+}//end mrms_binary_reader_cart3d function
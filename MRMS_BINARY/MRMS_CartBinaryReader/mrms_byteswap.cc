@@ -0,0 +1,161 @@
+#include <cstddef>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MRMS_X86_KERNELS 1
+#endif
+
+#include "mrms_byteswap.h"
+
+
+// C O N S T A N T S
+// none
+
+
+// F U N C T I O N S
+
+/*------------------------------------------------------------------
+
+	Function:	byteswap_int16_scalar
+
+	Purpose:	Reference kernel.  Swaps the two bytes of each
+	            element in place.
+
+------------------------------------------------------------------*/
+
+void byteswap_int16_scalar(short int *data, size_t num_elements)
+{
+    unsigned short *udata = reinterpret_cast< unsigned short * >( data );
+
+    for(size_t i = 0; i < num_elements; i++)
+    {
+      udata[i] = (unsigned short)( (udata[i] << 8) | (udata[i] >> 8) );
+    }
+}
+
+
+#ifdef MRMS_X86_KERNELS
+
+/*------------------------------------------------------------------
+
+	Function:	byteswap_int16_sse2
+
+	Purpose:	SSE2 has no byte shuffle, so swap 8 elements at a
+	            time with a pair of 16-bit shifts
+
+------------------------------------------------------------------*/
+
+__attribute__((target("sse2")))
+void byteswap_int16_sse2(short int *data, size_t num_elements)
+{
+    size_t i = 0;
+
+    for( ; i + 8 <= num_elements; i += 8)
+    {
+      __m128i *p = reinterpret_cast< __m128i * >( data + i );
+      __m128i v = _mm_loadu_si128(p);
+
+      v = _mm_or_si128( _mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8) );
+      _mm_storeu_si128(p, v);
+    }
+
+    byteswap_int16_scalar(data + i, num_elements - i);
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	byteswap_int16_avx2
+
+	Purpose:	Swap 32 elements per iteration with a byte
+	            shuffle (vpshufb)
+
+------------------------------------------------------------------*/
+
+__attribute__((target("avx2")))
+void byteswap_int16_avx2(short int *data, size_t num_elements)
+{
+    const __m256i mask = _mm256_setr_epi8(
+        1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+        1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 );
+
+    size_t i = 0;
+
+    for( ; i + 32 <= num_elements; i += 32)
+    {
+      __m256i *p = reinterpret_cast< __m256i * >( data + i );
+      __m256i v0 = _mm256_loadu_si256(p);
+      __m256i v1 = _mm256_loadu_si256(p + 1);
+
+      _mm256_storeu_si256(p, _mm256_shuffle_epi8(v0, mask));
+      _mm256_storeu_si256(p + 1, _mm256_shuffle_epi8(v1, mask));
+    }
+
+    byteswap_int16_sse2(data + i, num_elements - i);
+}
+
+#else
+
+//No vector kernels on this platform
+void byteswap_int16_sse2(short int *data, size_t num_elements)
+{
+    byteswap_int16_scalar(data, num_elements);
+}
+
+void byteswap_int16_avx2(short int *data, size_t num_elements)
+{
+    byteswap_int16_scalar(data, num_elements);
+}
+
+#endif
+
+
+/*------------------------------------------------------------------
+
+	Function:	byteswap_int16_kernel
+
+	Purpose:	Name of the kernel the CPU supports best
+
+------------------------------------------------------------------*/
+
+const char* byteswap_int16_kernel()
+{
+#ifdef MRMS_X86_KERNELS
+    __builtin_cpu_init();
+
+    if( __builtin_cpu_supports("avx2") ) return "avx2";
+    if( __builtin_cpu_supports("sse2") ) return "sse2";
+#endif
+
+    return "scalar";
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	byteswap_int16
+
+	Purpose:	Swap every element in place.  The kernel is
+	            chosen once, on first use.
+
+------------------------------------------------------------------*/
+
+typedef void (*byteswap_int16_func)(short int *, size_t);
+
+static byteswap_int16_func pick_byteswap_int16()
+{
+    const char *kernel = byteswap_int16_kernel();
+
+    if(strcmp(kernel, "avx2") == 0) return byteswap_int16_avx2;
+    if(strcmp(kernel, "sse2") == 0) return byteswap_int16_sse2;
+
+    return byteswap_int16_scalar;
+}
+
+void byteswap_int16(short int *data, size_t num_elements)
+{
+    static const byteswap_int16_func kernel = pick_byteswap_int16();
+
+    kernel(data, num_elements);
+}
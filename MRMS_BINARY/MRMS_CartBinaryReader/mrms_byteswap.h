@@ -0,0 +1,42 @@
+#ifndef MRMS_BYTESWAP_H
+#define MRMS_BYTESWAP_H
+
+#include <cstddef>
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	File:		mrms_byteswap
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	Byte swap kernels for the int16 data array of
+	            MRMS binary files.  byteswap_int16 picks the
+	            fastest kernel the CPU supports (AVX2, SSE2 or
+	            plain C) the first time it is called.  Readers
+	            call it only when the header probe says the file's
+	            byte order differs from the host's, so native
+	            files are never touched.
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+
+// F U N C T I O N  P R O T O T Y P E S
+
+//swap every element in place, using the best kernel for this CPU
+void byteswap_int16(short int *data, size_t num_elements);
+
+//the individual kernels, exposed for benchmarking
+void byteswap_int16_scalar(short int *data, size_t num_elements);
+void byteswap_int16_sse2(short int *data, size_t num_elements);
+void byteswap_int16_avx2(short int *data, size_t num_elements);
+
+//name of the kernel byteswap_int16 uses ("avx2", "sse2" or "scalar")
+const char* byteswap_int16_kernel();
+
+#endif
@@ -0,0 +1,206 @@
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+
+#include "mrms_inflate.h"
+
+using namespace std;
+
+
+// C O N S T A N T S
+// none
+
+
+// F U N C T I O N S
+
+/*------------------------------------------------------------------
+
+	Function:	mrms_inflate_default
+
+	Purpose:	Fastest backend this build supports
+
+------------------------------------------------------------------*/
+
+int mrms_inflate_default()
+{
+#ifdef HAVE_LIBDEFLATE
+    return MRMS_INFLATE_LIBDEFLATE;
+#else
+    return MRMS_INFLATE_ZLIB;
+#endif
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	mrms_inflate_available
+
+	Purpose:	True if the backend was compiled in
+
+------------------------------------------------------------------*/
+
+bool mrms_inflate_available(int backend)
+{
+    if(backend == MRMS_INFLATE_ZLIB) return true;
+
+#ifdef HAVE_LIBDEFLATE
+    if(backend == MRMS_INFLATE_LIBDEFLATE) return true;
+#endif
+
+    return false;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	mrms_inflate_name, mrms_inflate_backend
+
+	Purpose:	Convert between a backend and its name
+
+------------------------------------------------------------------*/
+
+const char* mrms_inflate_name(int backend)
+{
+    if(backend == MRMS_INFLATE_LIBDEFLATE) return "libdeflate";
+
+    return "zlib";
+}
+
+
+int mrms_inflate_backend(const char *name)
+{
+    if(strcmp(name, "zlib") == 0) return MRMS_INFLATE_ZLIB;
+    if(strcmp(name, "libdeflate") == 0) return MRMS_INFLATE_LIBDEFLATE;
+
+    return -1;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	mrms_gunzip_buffer
+
+	Purpose:	Inflate a whole gzip file that is already in
+	            memory.  Each gzip member is inflated straight into
+	            its place in out.  The output must fill out
+	            exactly.
+
+	Input:		in, in_bytes = gzip'd input and its size
+	            out, out_bytes = output buffer and its size
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+#ifdef HAVE_LIBDEFLATE
+
+int mrms_gunzip_buffer(const void *in, size_t in_bytes,
+                       void *out, size_t out_bytes)
+{
+    struct libdeflate_decompressor *d = libdeflate_alloc_decompressor();
+    if(d == 0) return -1;
+
+
+    //Inflate member by member until the output is full
+    const unsigned char *in_pos = static_cast< const unsigned char * >( in );
+    unsigned char *out_pos = static_cast< unsigned char * >( out );
+    size_t in_left = in_bytes;
+    size_t out_left = out_bytes;
+    int status = 1;
+
+    while( (out_left > 0) && (in_left > 0) )
+    {
+      size_t used_in = 0, used_out = 0;
+
+      enum libdeflate_result result = libdeflate_gzip_decompress_ex(d,
+          in_pos, in_left, out_pos, out_left, &used_in, &used_out);
+
+      if( (result != LIBDEFLATE_SUCCESS) || (used_in == 0) )
+      {
+        status = -1;
+        break;
+      }
+
+      in_pos += used_in;
+      in_left -= used_in;
+      out_pos += used_out;
+      out_left -= used_out;
+    }
+
+    if(out_left > 0) status = -1;
+
+    libdeflate_free_decompressor(d);
+
+    return status;
+}
+
+#else
+
+//Not built with libdeflate (see mrms_inflate_available)
+int mrms_gunzip_buffer(const void *in, size_t in_bytes,
+                       void *out, size_t out_bytes)
+{
+    return -1;
+}
+
+#endif
+
+
+/*------------------------------------------------------------------
+
+	Function:	mrms_gunzip_file
+
+	Purpose:	Inflate a whole gzip file in one pass.  The
+	            compressed file is mapped rather than read and
+	            inflated with mrms_gunzip_buffer.
+
+	Input:		vfname = gzip file name and path
+	            out, out_bytes = output buffer and its size
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+#ifdef HAVE_LIBDEFLATE
+
+int mrms_gunzip_file(const char *vfname, void *out, size_t out_bytes)
+{
+    int fd = open(vfname, O_RDONLY);
+    if(fd < 0) return -1;
+
+    struct stat st;
+    if( (fstat(fd, &st) != 0) || (st.st_size <= 0) )
+    {
+      close(fd);
+      return -1;
+    }
+
+    size_t in_bytes = (size_t)st.st_size;
+    void *in = mmap(0, in_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(in == MAP_FAILED) return -1;
+    madvise(in, in_bytes, MADV_SEQUENTIAL);
+
+    int status = mrms_gunzip_buffer(in, in_bytes, out, out_bytes);
+
+    munmap(in, in_bytes);
+
+    return status;
+}
+
+#else
+
+//Not built with libdeflate (see mrms_inflate_available)
+int mrms_gunzip_file(const char *vfname, void *out, size_t out_bytes)
+{
+    return -1;
+}
+
+#endif
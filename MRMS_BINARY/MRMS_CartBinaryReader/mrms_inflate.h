@@ -0,0 +1,60 @@
+#ifndef MRMS_INFLATE_H
+#define MRMS_INFLATE_H
+
+#include <cstddef>
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	File:		mrms_inflate
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	Decompression backends for whole-file reads of
+	            gzip'd MRMS binary files.
+
+	            MRMS_INFLATE_ZLIB streams the file through gzread.
+	            MRMS_INFLATE_LIBDEFLATE maps the compressed file
+	            (or uses it in place, if already in memory) and
+	            inflates it in a single libdeflate call into a
+	            buffer sized from the header (checked against the
+	            gzip trailer's ISIZE).  It is only available when
+	            built with -DHAVE_LIBDEFLATE (see the Makefile);
+	            otherwise zlib is used.
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+
+// C O N S T A N T S
+
+static const int MRMS_INFLATE_ZLIB = 0;
+static const int MRMS_INFLATE_LIBDEFLATE = 1;
+
+
+// F U N C T I O N  P R O T O T Y P E S
+
+//fastest backend this build supports
+int mrms_inflate_default();
+
+//true if the backend was compiled in
+bool mrms_inflate_available(int backend);
+
+//name of a backend ("zlib" or "libdeflate"), and the reverse
+//(-1 if the name is unknown)
+const char* mrms_inflate_name(int backend);
+int mrms_inflate_backend(const char *name);
+
+//inflate a whole gzip file (all members) into out, which must be
+//exactly out_bytes long.  Returns 1 on success, -1 on failure
+int mrms_gunzip_file(const char *vfname, void *out, size_t out_bytes);
+
+//same, for a gzip file already in memory
+int mrms_gunzip_buffer(const void *in, size_t in_bytes,
+                       void *out, size_t out_bytes);
+
+#endif
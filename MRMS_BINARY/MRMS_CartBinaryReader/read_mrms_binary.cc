@@ -1,241 +1,469 @@
-#include <iostream>
-#include <vector>
-#include <string>
-
-#include "mrms_binary_reader.h"
-
-using namespace std;   
-
-/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
-
-	Program:	read_mrms_binary.cc
-	            (newer version of read_nmq_binary.cc)
-	
-	Date:		July 2013
-	
-	Author:		Carrie Langston (CIMMS/NSSL)
-	        	
-	Purpose:	This program will read in a MRMS binary file,
-	            reassign the 1D input to a 3D array, and
-	            unscale the data field.
-		
-	Input:		2 command-line arguments:
-					1) input file path and name
-					2) swap byte flag 
-					     = 0; no
-					     = 1; yes
-					     
-	            NOTE: You may need to set the swap byte flag to 1  
-	            if the OS you're using to read the binary file 
-	            differs from the one used to write the file, 
-	            such that the endain order differs (i.e., 
-	            "Little Endian" vs. "Big Endian").  The program 
-	            will likely crash if the swap flag is set
-	            incorrectly (so you'll find out quickly if it
-	            needs to be set to 0 or 1). 
-	                  
-	Output: 	Messages to standard output
-				
-				
-	To Compile:	If using g++ compiler...
-	            g++ -o read_mrms_binary read_mrms_binary.cc -lz
-	           	
-	To Run:		read_mrms_binary <input file> <swap flag>
-																											
-	_____________________________________________________________			
-	Modification History:
-	       
-        12/08/2014  Carrie Langston (CIMMS/NSSL)
-        - Updated nmq_binary_reader.h to correctly compute the
-        data file's time in epoch seconds
-
-%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
-
-
-/************************************************/
-/***  F U N C T I O N  P R O T O T Y P E (S)  ***/
-/************************************************/
-
-short int* mrms_binary_reader_cart3d(char *vfname,                     
-                     char *varname,char *varunit,
-                     int &nradars, vector<string> &radarnam,
-                     int &var_scale, int &missing_val,
-                     float &nw_lon, float &nw_lat,
-                     int &nx, int &ny, float &dx, float &dy,
-                     float zp[], int &nz, long &epoch_seconds,
-                     int swap_flag);
-                   
-                   
-
-/********************************/
-/***  M A I N  P R O G R A M  ***/
-/********************************/
-
-int main(int argc,  char* argv[])
-{
-    cout<<"\n\n"<<endl;
-    cout<<"      *************************************************"<<endl;
-    cout<<"      *                                               *"<<endl;
-    cout<<"      *          WELCOME TO MRMS BINARY READER        *"<<endl;
-    cout<<"      *                   Dec  2014                   *"<<endl;
-    cout<<"      *                                               *"<<endl;
-    cout<<"      *************************************************"<<endl;
-    cout<<endl;
-    
-
-
-    /*---------------------------------------*/
-    /*** 0. Process command-line arguments ***/ 
-    /*---------------------------------------*/
-
-    //Process command-line arguments
-    if(argc!=3)
-    {
-      cout<<"Usage:  read_mrms_binary /path/input_file swap_flag"<<endl;
-      cout<<"        swap_flag = 0 or 1; see read_mrms_binary.cc "
-          <<"header for more info"<<endl;
-      cout<<"Exiting from read_mrms_binary."<<endl<<endl;
-      exit(0);
-    }
-
-    char input_file[300];
-    strcpy(input_file, argv[1]);
-
-    int swap_flag = atoi(argv[2]);
-    
-
-
-    /*---------------------------------------------------*/
-    /*** 1. Declare several variables needed by reader ***/
-    /*---------------------------------------------------*/
-
-    char varname[20];
-    char varunit[6];
-    int nradars;
-    vector<string> radarnames;
-    int var_scale, missing;
-    float nw_lat, nw_lon;
-    int nx, ny, nz;
-    float dx, dy;
-    float zhgt[50]; //assuming there will be <50 levels!
-    long epoch_sec;
-
-    short int* input_data_1D = 0;
-
-
-
-    /*-------------------------*/
-    /*** 2. Read input field ***/
-    /*-------------------------*/
-
-    //Read file
-    input_data_1D = mrms_binary_reader_cart3d(input_file,                     
-                           varname, varunit,
-                           nradars, radarnames,
-                           var_scale, missing,
-                           nw_lon, nw_lat,
-                           nx, ny, dx, dy,
-                           zhgt, nz, epoch_sec, swap_flag);
-
-
-    //Perform some error checking
-    if(input_data_1D == 0)
-    {
-      cout<<"+++ERROR: Failed to read "<<input_file<<" Exiting!"<<endl;
-      return 0;
-    }
-    cout<<"DONE reading file"<<endl<<endl;
-    
-
-    //Print out header info.
-    cout<<"Binary Header Info:"<<endl;
-    cout<<" variable name = "<<varname<<endl;
-    cout<<" variable unit = "<<varunit<<endl;
-    cout<<" number of radars = "<<nradars<<endl;
-    
-    cout<<" Radars: ";
-    for(size_t i = 0; i < radarnames.size(); i++)
-      cout<<radarnames[i]<<" ";
-    cout<<endl;
-    
-    cout<<" variable scale = "<<var_scale<<endl;
-    cout<<" missing value = "<<missing<<endl;
-    cout<<" NW latitude = "<<nw_lat<<endl;
-    cout<<" NW longitude = "<<nw_lon<<endl;
-    cout<<" Number of columns = "<<nx<<endl;
-    cout<<" Number of rows = "<<ny<<endl;
-    cout<<" Number of levels = "<<nz<<endl;
-    cout<<" Grid cell size (degree lat.) = "<<dy<<endl;
-    cout<<" Grid cell size (degree lon.) = "<<dx<<endl;
-    
-    cout<<" Level heights (m MSL) = ";
-    for(int i = 0; i < nz; i++) cout<<zhgt[i]<<" ";
-    cout<<endl;
-    
-    char timestamp[20];
-    strftime(timestamp, 20, "%m/%d/%Y %H%M%S", gmtime(&epoch_sec));
-    cout<<" Time = "<<timestamp<<" UTC  (or "<<epoch_sec
-        <<" epoch seconds)"<<endl<<endl;
-
-      
-    
-    /*----------------------------------------------*/
-    /*** 3. Reassign to 3D array and unscale data ***/
-    /*----------------------------------------------*/
-    
-    //NOTE: The field's origin (data_3D[0][0][0]) is the SW corner's  
-    //      lowest level.  As j increases so does the latitude.
-    //NOTE: For 2D data nz = 1
-    
-    float ***data_3D = new float** [nz];
-    for(int k = 0; k < nz; k++)
-    {
-      data_3D[k] = new float* [nx];
-      for(int i = 0; i < nx; i++) data_3D[k][i] = new float [ny];
-    }
-    int index = -1;
-    
-    for(int k = 0; k < nz; k++)
-    {
-      for(int i = 0; i < nx; i++)
-      {
-        for(int j = 0; j < ny; j++)
-        {
-          index = k*nx*ny + j*nx + i;
-          data_3D[k][i][j] = (float)input_data_1D[index] / (float)var_scale;
-        } 
-      }
-    }
-        
-    
-
-    /*------------------------*/
-    /*** 4. Free-up Memory, ***/
-    /*------------------------*/
-
-    //memory clean-up
-    if(input_data_1D != 0) delete [] input_data_1D;
-        
-    if(data_3D != 0)
-    {
-      for(int k = 0; k < nz; k++)
-      {
-        for(int i = 0; i < nx; i++) delete [] data_3D[k][i];
-        delete [] data_3D[k];
-      }
-      delete [] data_3D;
-    }
-        
-
-    return 1;
-    
-}//end main function
-
-
-
-
-/**************************/
-/*** F U N C T I O N S  ***/
-/**************************/
-
-//see mrms_binary_reader.h
+#include <iostream>
+#include <vector>
+#include <string>
+#include <string.h>
+#include <cstdlib>
+
+#include "mrms_binary_reader.h"
+#include "MrmsGzIndex.h"
+#include "MrmsTarReader.h"
+
+using namespace std;   
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	Program:	read_mrms_binary.cc
+	            (newer version of read_nmq_binary.cc)
+	
+	Date:		July 2013
+	
+	Author:		Carrie Langston (CIMMS/NSSL)
+	        	
+	Purpose:	This program will read in a MRMS binary file,
+	            reassign the 1D input to a 3D array, and
+	            unscale the data field.
+		
+	Input:		2 command-line arguments:
+					1) input file path and name
+					2) swap byte flag 
+					     = 0; no
+					     = 1; yes
+					     = auto (or -1); detect from header
+
+	            or, to only read file headers (probe mode):
+					1) -probe
+					2) swap byte flag
+					3) one or more input files
+
+	            or, to build random-access indexes (index mode):
+					1) -index
+					2) one or more gzip'd input files
+					   (writes <file>.gzidx next to each)
+					     
+	            NOTE: You may need to set the swap byte flag to 1  
+	            if the OS you're using to read the binary file 
+	            differs from the one used to write the file, 
+	            such that the endain order differs (i.e., 
+	            "Little Endian" vs. "Big Endian").  With "auto"
+	            the reader tries both orders on the header and
+	            keeps the one that gives a sensible date and grid.
+	            A wrong 0/1 flag is reported as a bad header.
+	                  
+	Output: 	Messages to standard output
+				
+				
+	To Compile:	Use make.  Or if using g++ compiler...
+	            g++ -O2 -o read_mrms_binary read_mrms_binary.cc \
+	                MrmsBufferPool.cc MrmsGrid.cc MrmsGzIndex.cc MrmsSource.cc \
+	                MrmsTarReader.cc \
+	                mrms_binary_reader.cc mrms_byteswap.cc mrms_inflate.cc -lz
+	           	
+	To Run:		read_mrms_binary <input file> <swap flag>
+	            read_mrms_binary -probe <swap flag> <input file(s)>
+	            read_mrms_binary -index <input file(s)>
+																											
+	_____________________________________________________________			
+	Modification History:
+	       
+        12/08/2014  Carrie Langston (CIMMS/NSSL)
+        - Updated nmq_binary_reader.h to correctly compute the
+        data file's time in epoch seconds
+
+        10/17/2026  CIMMS/NSSL
+        - Read files through the MrmsGrid class, which owns the
+        header and data.  No more fixed-size name/height buffers.
+        The converter now shares this reader.
+        - Added -probe mode, which reads only file headers
+        - swap flag may be "auto" to detect the byte order
+        - Added -index mode, which builds random-access indexes
+        - Reader errors are returned as messages (errorMessage)
+        and printed here; gmtime_r instead of gmtime
+        - 64-bit data index, for grids of more than 2^31 values
+        - -probe lists each member of a tar archive (.tar, .tar.gz,
+        .tgz), read in place through MrmsTarReader
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+
+/************************************************/
+/***  F U N C T I O N  P R O T O T Y P E (S)  ***/
+/************************************************/
+
+//see mrms_binary_reader.h
+
+int parse_swap_flag(const char *arg);
+int probe_files(int swap_flag, int num_files, char* files[]);
+int probe_archive(int swap_flag, const char *archive_file,
+                  MrmsByteOrderCache &byte_orders);
+void print_probe(const string &file, const MrmsHeader &hdr);
+int index_files(int num_files, char* files[]);
+
+
+
+/********************************/
+/***  M A I N  P R O G R A M  ***/
+/********************************/
+
+int main(int argc,  char* argv[])
+{
+    //Probe mode prints one line per file and nothing else, so it
+    //can be piped into other tools
+    if( (argc > 3) && (strcmp(argv[1], "-probe") == 0) )
+    {
+      return probe_files(parse_swap_flag(argv[2]), argc-3, &argv[3]);
+    }
+
+    if( (argc > 2) && (strcmp(argv[1], "-index") == 0) )
+    {
+      return index_files(argc-2, &argv[2]);
+    }
+
+    cout<<"\n\n"<<endl;
+    cout<<"      *************************************************"<<endl;
+    cout<<"      *                                               *"<<endl;
+    cout<<"      *          WELCOME TO MRMS BINARY READER        *"<<endl;
+    cout<<"      *                   Dec  2014                   *"<<endl;
+    cout<<"      *                                               *"<<endl;
+    cout<<"      *************************************************"<<endl;
+    cout<<endl;
+    
+
+
+    /*---------------------------------------*/
+    /*** 0. Process command-line arguments ***/ 
+    /*---------------------------------------*/
+
+    //Process command-line arguments
+    if(argc!=3)
+    {
+      cout<<"Usage:  read_mrms_binary /path/input_file swap_flag"<<endl;
+      cout<<"        read_mrms_binary -probe swap_flag /path/input_file(s)"<<endl;
+      cout<<"        read_mrms_binary -index /path/input_file(s)"<<endl;
+      cout<<"        swap_flag = 0, 1 or auto; see read_mrms_binary.cc "
+          <<"header for more info"<<endl;
+      cout<<"        -probe: read only the header of each file and print "
+          <<"one line per file (name, unit, time, grid); a tar "
+          <<"archive gives one line per member"<<endl;
+      cout<<"        -index: build a random-access index (<file>.gzidx) "
+          <<"for each gzip'd file, so single levels/rows can be read "
+          <<"without inflating the whole file"<<endl;
+      cout<<"Exiting from read_mrms_binary."<<endl<<endl;
+      exit(0);
+    }
+
+    char input_file[300];
+    strcpy(input_file, argv[1]);
+
+    int swap_flag = parse_swap_flag(argv[2]);
+    
+
+
+    /*-------------------------*/
+    /*** 1. Read input field ***/
+    /*-------------------------*/
+
+    //Read file
+    MrmsGrid grid;
+
+    //Perform some error checking
+    if(grid.read(input_file, swap_flag) < 0)
+    {
+      cout<<"+++ERROR: "<<grid.errorMessage()<<endl;
+      cout<<"+++ERROR: Failed to read "<<input_file<<" Exiting!"<<endl;
+      return 0;
+    }
+    if( !grid.warningMessage().empty() )
+      cout<<"+++WARNING: "<<grid.warningMessage()<<endl;
+    cout<<"DONE reading file"<<endl<<endl;
+    
+
+    //Print out header info.
+    const MrmsHeader &hdr = grid.header();
+    int nx = hdr.nx, ny = hdr.ny, nz = hdr.nz;
+
+    cout<<"Binary Header Info:"<<endl;
+    cout<<" variable name = "<<hdr.varName<<endl;
+    cout<<" variable unit = "<<hdr.varUnit<<endl;
+    cout<<" number of radars = "<<hdr.nradars<<endl;
+    
+    cout<<" Radars: ";
+    for(size_t i = 0; i < hdr.radarNames.size(); i++)
+      cout<<hdr.radarNames[i]<<" ";
+    cout<<endl;
+    
+    cout<<" variable scale = "<<hdr.varScale<<endl;
+    cout<<" missing value = "<<hdr.missingVal<<endl;
+    cout<<" NW latitude = "<<hdr.nwLat<<endl;
+    cout<<" NW longitude = "<<hdr.nwLon<<endl;
+    cout<<" Number of columns = "<<nx<<endl;
+    cout<<" Number of rows = "<<ny<<endl;
+    cout<<" Number of levels = "<<nz<<endl;
+    cout<<" Grid cell size (degree lat.) = "<<hdr.dy<<endl;
+    cout<<" Grid cell size (degree lon.) = "<<hdr.dx<<endl;
+    
+    cout<<" Level heights (m MSL) = ";
+    for(int i = 0; i < nz; i++) cout<<hdr.zhgt[i]<<" ";
+    cout<<endl;
+    
+    char timestamp[20];
+    time_t epoch_sec = hdr.epochSeconds;
+    struct tm valid_time;
+    gmtime_r(&epoch_sec, &valid_time);
+    strftime(timestamp, 20, "%m/%d/%Y %H%M%S", &valid_time);
+    cout<<" Time = "<<timestamp<<" UTC  (or "<<epoch_sec
+        <<" epoch seconds)"<<endl<<endl;
+
+      
+    
+    /*----------------------------------------------*/
+    /*** 2. Reassign to 3D array and unscale data ***/
+    /*----------------------------------------------*/
+    
+    //NOTE: The field's origin (data_3D[0][0][0]) is the SW corner's  
+    //      lowest level.  As j increases so does the latitude.
+    //NOTE: For 2D data nz = 1
+    
+    const short int *input_data_1D = grid.data();
+
+    float ***data_3D = new float** [nz];
+    for(int k = 0; k < nz; k++)
+    {
+      data_3D[k] = new float* [nx];
+      for(int i = 0; i < nx; i++) data_3D[k][i] = new float [ny];
+    }
+    size_t index = 0;
+    
+    //size_t: a 3D grid can hold more than 2^31 values
+    for(int k = 0; k < nz; k++)
+    {
+      for(int i = 0; i < nx; i++)
+      {
+        for(int j = 0; j < ny; j++)
+        {
+          index = ((size_t)k*ny + j)*nx + i;
+          data_3D[k][i][j] = (float)input_data_1D[index] / (float)hdr.varScale;
+        } 
+      }
+    }
+        
+    
+
+    /*------------------------*/
+    /*** 3. Free-up Memory, ***/
+    /*------------------------*/
+
+    //memory clean-up (grid frees its own data)
+
+    if(data_3D != 0)
+    {
+      for(int k = 0; k < nz; k++)
+      {
+        for(int i = 0; i < nx; i++) delete [] data_3D[k][i];
+        delete [] data_3D[k];
+      }
+      delete [] data_3D;
+    }
+        
+
+    return 1;
+    
+}//end main function
+
+
+
+
+/**************************/
+/*** F U N C T I O N S  ***/
+/**************************/
+
+//also see MrmsGrid.cc and mrms_binary_reader.cc
+
+/*------------------------------------------------------------------
+
+	Function:	parse_swap_flag
+
+	Purpose:	Convert the swap flag argument ("0", "1", "auto"
+	            or "-1") to a reader swap_flag
+
+------------------------------------------------------------------*/
+
+int parse_swap_flag(const char *arg)
+{
+    if(strcmp(arg, "auto") == 0) return MRMS_SWAP_AUTO;
+
+    int swap_flag = atoi(arg);
+    if( (swap_flag != 0) && (swap_flag != 1) ) return MRMS_SWAP_AUTO;
+
+    return swap_flag;
+
+}//end function parse_swap_flag
+
+
+
+/*------------------------------------------------------------------
+
+	Function:	probe_files
+
+	Purpose:	Read only the header of each file and print one
+	            line per file:
+	             file name unit YYYYmmdd-HHMMSS nx ny nz
+	             nw_lat nw_lon dy dx
+	            Files that fail are reported on their own line
+	            starting with "+++ERROR".  A tar archive gives
+	            one line per member (see probe_archive).
+
+	Output:		int = 1 if all files were read, else 0
+
+------------------------------------------------------------------*/
+
+int probe_files(int swap_flag, int num_files, char* files[])
+{
+    int all_ok = 1;
+    MrmsByteOrderCache byte_orders;
+
+    for(int f = 0; f < num_files; f++)
+    {
+      if( MrmsTarReader::isArchiveName(files[f]) )
+      {
+        if(probe_archive(swap_flag, files[f], byte_orders) < 1) all_ok = 0;
+        continue;
+      }
+
+      MrmsHeader hdr;
+      string error;
+
+      if(hdr.probe(files[f], swap_flag, &byte_orders, &error) < 0)
+      {
+        cout<<"+++ERROR: "<<error<<endl;
+        all_ok = 0;
+        continue;
+      }
+
+      print_probe(files[f], hdr);
+    }
+
+    return all_ok;
+
+}//end function probe_files
+
+
+
+/*------------------------------------------------------------------
+
+	Function:	probe_archive
+
+	Purpose:	Probe each member of a tar archive, in one pass
+	            over the archive, and print one line per member
+	            as probe_files does (file = archive/member)
+
+	Output:		int = 1 if all members were read, else 0
+
+------------------------------------------------------------------*/
+
+int probe_archive(int swap_flag, const char *archive_file,
+                  MrmsByteOrderCache &byte_orders)
+{
+    int all_ok = 1;
+    MrmsTarReader archive;
+
+    if(archive.open(archive_file) < 0)
+    {
+      cout<<"+++ERROR: "<<archive.errorMessage()<<endl;
+      return 0;
+    }
+
+    int status;
+    while( (status = archive.next()) > 0 )
+    {
+      MrmsSource *member = archive.member();
+      MrmsHeader hdr;
+      string error;
+
+      if(member == 0)
+      {
+        cout<<"+++ERROR: "<<archive.errorMessage()<<endl;
+        return 0;
+      }
+
+      if(hdr.probe(*member, swap_flag, &byte_orders, &error) < 0)
+      {
+        cout<<"+++ERROR: "<<error<<endl;
+        all_ok = 0;
+        continue;
+      }
+
+      print_probe(member->name(), hdr);
+    }
+
+    if(status < 0)
+    {
+      cout<<"+++ERROR: "<<archive.errorMessage()<<endl;
+      all_ok = 0;
+    }
+
+    return all_ok;
+
+}//end function probe_archive
+
+
+
+/*------------------------------------------------------------------
+
+	Function:	print_probe
+
+	Purpose:	Print the probe line for one file:
+	             file name unit YYYYmmdd-HHMMSS nx ny nz
+	             nw_lat nw_lon dy dx
+
+------------------------------------------------------------------*/
+
+void print_probe(const string &file, const MrmsHeader &hdr)
+{
+    char timestamp[20];
+    time_t epoch_sec = hdr.epochSeconds;
+    struct tm valid_time;
+    gmtime_r(&epoch_sec, &valid_time);
+    strftime(timestamp, 20, "%Y%m%d-%H%M%S", &valid_time);
+
+    cout<<file<<" "<<hdr.varName<<" "<<hdr.varUnit<<" "
+        <<timestamp<<" "<<hdr.nx<<" "<<hdr.ny<<" "<<hdr.nz<<" "
+        <<hdr.nwLat<<" "<<hdr.nwLon<<" "<<hdr.dy<<" "<<hdr.dx<<endl;
+
+}//end function print_probe
+
+
+
+/*------------------------------------------------------------------
+
+	Function:	index_files
+
+	Purpose:	Build (or refresh) the random-access index sidecar
+	            of each file and print one line per file:
+	             file sidecar number_of_checkpoints
+
+	Output:		int = 1 if all files were indexed, else 0
+
+------------------------------------------------------------------*/
+
+int index_files(int num_files, char* files[])
+{
+    int all_ok = 1;
+
+    for(int f = 0; f < num_files; f++)
+    {
+      MrmsGzIndex index;
+
+      if( (index.build(files[f]) < 0) || (index.save() < 0) )
+      {
+        cout<<"+++ERROR: "<<index.errorMessage()<<endl;
+        all_ok = 0;
+        continue;
+      }
+
+      cout<<files[f]<<" "<<MrmsGzIndex::sidecarName(files[f])<<" "
+          <<index.numPoints()<<endl;
+    }
+
+    return all_ok;
+
+}//end function index_files
@@ -0,0 +1,358 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <thread>
+#include <fnmatch.h>
+
+#include "ConverterOptions.h"
+#include "OutputFormat.h"
+#include "MrmsGrid.h"
+#include "mrms_inflate.h"
+#include "mrms_unscale.h"
+
+using namespace std;
+
+
+/*****************************/
+/*****************************/
+/** C O N S T R U C T O R S **/
+/*****************************/
+
+//default constructor
+ConverterOptions::ConverterOptions()
+{
+    swapFlag = MRMS_SWAP_AUTO;
+    faaCompliant = false;
+    swOrigin = false;
+    packed = false;
+
+    OutputFormat format_defaults;
+    netcdf4 = format_defaults.netcdf4;
+    deflateLevel = format_defaults.deflateLevel;
+    shuffle = format_defaults.shuffle;
+    chunkRows = (int)format_defaults.chunkRows;
+    chunkCols = (int)format_defaults.chunkCols;
+    inflateBackend = mrms_inflate_default();
+    simdIsa = mrms_simd_default();
+
+    numThreads = (int)thread::hardware_concurrency();
+    if(numThreads < 1) numThreads = 1;
+
+    hugePages = false;
+    queueDepth = 8;
+
+    cropGrid = false;
+    cropSouth = cropNorth = cropWest = cropEast = 0.0;
+}
+
+/************************************/
+/** E N D  C O N S T R U C T O R S **/
+/************************************/
+/************************************/
+
+
+
+/********************************/
+/********************************/
+/** P U B L I C  M E T H O D S **/
+/********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		parse
+
+	Purpose:	Set options from argv[first_arg] onward.  Unknown
+	            options are reported and ignored.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int ConverterOptions::parse(int argc, char* argv[], int first_arg)
+{
+    for(int a = first_arg; a < argc; a++)
+    {
+      string option = argv[a];
+
+      if(option == "-swap") swapFlag = 1;
+      else if(option == "-noswap") swapFlag = 0;
+      else if(option == "-faa") faaCompliant = true;
+      else if(option == "-sworigin") swOrigin = true;
+      else if(option == "-packed") packed = true;
+      else if(option == "-netcdf4") netcdf4 = true;
+      else if( (option == "-deflate") && (a+1 < argc) )
+      {
+        deflateLevel = atoi(argv[++a]);
+
+        if( (deflateLevel < 0) || (deflateLevel > 9) )
+        {
+          cout<<"+++ERROR: -deflate needs a level from 0 to 9"<<endl;
+          return -1;
+        }
+      }
+      else if(option == "-noshuffle") shuffle = false;
+      else if( (option == "-filter") && (a+1 < argc) )
+      {
+        //[GLOB=]SPEC; no GLOB is every product
+        string arg = argv[++a];
+        size_t equals = arg.find('=');
+        string pattern = (equals == string::npos) ? "*" : arg.substr(0, equals);
+        OutputFilter filter;
+
+        if(filter.parse( (equals == string::npos) ? arg : arg.substr(equals+1) ) < 0)
+        {
+          cout<<"+++ERROR: Unknown compression filter "<<arg<<endl;
+          return -1;
+        }
+
+        filterPatterns.push_back(pattern);
+        filters.push_back(filter);
+        netcdf4 = true;
+      }
+      else if( (option == "-chunk") && (a+2 < argc) )
+      {
+        chunkRows = atoi(argv[++a]);
+        chunkCols = atoi(argv[++a]);
+
+        if( (chunkRows < 0) || (chunkCols < 0) )
+        {
+          cout<<"+++ERROR: -chunk needs rows and columns of 0 or more"<<endl;
+          return -1;
+        }
+      }
+      else if( (option == "-inflate") && (a+1 < argc) )
+      {
+        inflateBackend = mrms_inflate_backend(argv[++a]);
+
+        if( !mrms_inflate_available(inflateBackend) )
+        {
+          cout<<"+++ERROR: Decompression backend "<<argv[a]
+              <<" is not available in this build"<<endl;
+          return -1;
+        }
+      }
+      else if( (option == "-simd") && (a+1 < argc) )
+      {
+        simdIsa = mrms_simd_isa(argv[++a]);
+
+        if( !mrms_simd_available(simdIsa) )
+        {
+          cout<<"+++ERROR: Instruction set "<<argv[a]
+              <<" is not available on this machine"<<endl;
+          return -1;
+        }
+      }
+      else if( (option == "-threads") && (a+1 < argc) )
+      {
+        numThreads = atoi(argv[++a]);
+
+        if(numThreads < 1)
+        {
+          cout<<"+++ERROR: -threads needs a number of 1 or more"<<endl;
+          return -1;
+        }
+      }
+      else if(option == "-hugepages") hugePages = true;
+      else if( (option == "-queue") && (a+1 < argc) )
+      {
+        queueDepth = atoi(argv[++a]);
+
+        if(queueDepth < 0)
+        {
+          cout<<"+++ERROR: -queue needs a number of 0 or more"<<endl;
+          return -1;
+        }
+      }
+      else if( (option == "-bbox") && (a+4 < argc) )
+      {
+        cropGrid = true;
+        cropSouth = atof(argv[++a]);
+        cropNorth = atof(argv[++a]);
+        cropWest = atof(argv[++a]);
+        cropEast = atof(argv[++a]);
+
+        if( (cropSouth > cropNorth) || (cropWest > cropEast) )
+        {
+          cout<<"+++ERROR: -bbox needs south north west east, with "
+              <<"south <= north and west <= east"<<endl;
+          return -1;
+        }
+      }
+      else if( (option == "-member") && (a+1 < argc) ) memberPattern = argv[++a];
+      else if( (option == "-field") && (a+1 < argc) ) fieldPattern = argv[++a];
+      else cout<<"Ignoring unknown option "<<option<<endl;
+    }
+
+    return 1;
+
+}//end public method ConverterOptions::parse
+
+
+/*------------------------------------------------------------------
+
+	Method:		print
+
+	Purpose:	Print the options in effect
+
+------------------------------------------------------------------*/
+
+void ConverterOptions::print() const
+{
+    cout<<"Swap flag for little vs. big endian is ";
+    if(swapFlag == 1) cout<<"on"<<endl;
+    else if(swapFlag == 0) cout<<"off"<<endl;
+    else cout<<"auto (detected from each file's header)"<<endl;
+
+    if(faaCompliant)
+      cout<<"Output will be FAA display compliant"<<endl;
+
+    if(swOrigin)
+      cout<<"Output keeps the input's SW origin (Lat ascending)"<<endl;
+
+    if(packed)
+      cout<<"Output data are packed short ints (CF scale_factor)"<<endl;
+
+    if(netcdf4)
+    {
+      cout<<"Output is netCDF-4, in chunks of "<<chunkRows<<" x "<<chunkCols
+          <<" cells, deflate level "<<deflateLevel;
+      if(shuffle) cout<<" with shuffle";
+      cout<<" (not gzip'd)"<<endl;
+    }
+
+    for(size_t f = 0; f < filters.size(); f++)
+      cout<<"Compressing "<<filterPatterns[f]<<" with "<<filters[f].name()<<endl;
+
+    cout<<"Decompressing gzip'd input with "<<mrms_inflate_name(inflateBackend)
+        <<" (or "<<numThreads<<" threads for indexed files)"<<endl;
+
+    cout<<"Unscaling data with "<<mrms_simd_name(simdIsa)<<" kernels, and "
+        <<"gzip'ing output, on "<<numThreads<<" thread(s)"<<endl;
+
+    if(hugePages)
+      cout<<"Data buffers use transparent huge pages"<<endl;
+
+    if(queueDepth > 0)
+      cout<<"Reading up to "<<queueDepth<<" input files ahead"<<endl;
+
+    if(cropGrid)
+      cout<<"Cropping output to "<<cropSouth<<" to "<<cropNorth<<" N, "
+          <<cropWest<<" to "<<cropEast<<" E"<<endl;
+
+    if( !memberPattern.empty() )
+      cout<<"Converting archive members named "<<memberPattern<<endl;
+
+    if( !fieldPattern.empty() )
+      cout<<"Converting only fields named "<<fieldPattern<<endl;
+
+}//end public method ConverterOptions::print
+
+
+/*------------------------------------------------------------------
+
+	Method:		filterFor
+
+	Purpose:	The -filter given for product (an output variable
+	            name): the first whose pattern matches it
+
+	Output:		const OutputFilter* (0 if none matches)
+
+------------------------------------------------------------------*/
+
+const OutputFilter* ConverterOptions::filterFor(const string &product) const
+{
+    for(size_t f = 0; f < filters.size(); f++)
+      if(fnmatch(filterPatterns[f].c_str(), product.c_str(), 0) == 0)
+        return &filters[f];
+
+    return 0;
+
+}//end public method ConverterOptions::filterFor
+
+
+/*------------------------------------------------------------------
+
+	Method:		printUsage
+
+	Purpose:	Print the optional arguments parse understands
+
+------------------------------------------------------------------*/
+
+void ConverterOptions::printUsage()
+{
+    OutputFormat format_defaults;
+
+    cout<<"  (optional arguments)"<<endl;
+    cout<<"    -swap: turns on byte swapping when reading input files.  By "
+        <<"default the byte order (little vs. big endian) is detected from "
+        <<"each file's header; use this only to force it."<<endl;
+    cout<<"    -noswap: turns off byte swapping (no detection)"<<endl;
+    cout<<"    -inflate zlib|libdeflate: decompression backend for gzip'd "
+        <<"input (default: "<<mrms_inflate_name(mrms_inflate_default())
+        <<")"<<endl;
+    cout<<"    -simd scalar|sse2|avx2|avx512: instruction set used to "
+        <<"unscale data (default: widest this CPU has, "
+        <<mrms_simd_name(mrms_simd_default())<<").  Output is the same "
+        <<"for all"<<endl;
+    cout<<"    -threads N: threads used to unscale and flip big levels "
+        <<"(in blocks of rows; output is the same for any N), to gzip "
+        <<"big output files (pigz-style, one standard gzip stream), and to "
+        <<"inflate input files that have a random-access index "
+        <<"(<file>.gzidx, see read_mrms_binary -index).  Default: number "
+        <<"of cores"<<endl;
+    cout<<"    -hugepages: allocate data buffers of 2 MB or more on "
+        <<"transparent huge pages"<<endl;
+    cout<<"    -queue N: when converting a directory, keep reads of up to N "
+        <<"gzip'd files of up to 16 MB in flight (io_uring) while "
+        <<"converting.  0 reads each file when it is reached.  "
+        <<"Default: 8"<<endl;
+    cout<<"    -bbox S N W E: write only the grid cells whose centers lie "
+        <<"between latitudes S and N and longitudes W and E (degrees, "
+        <<"west negative).  Rows outside the box are never stored"<<endl;
+    cout<<"    -member GLOB: convert only the members of tar archive input "
+        <<"(.tar, .tar.gz, .tgz) whose names match GLOB, e.g. "
+        <<"'*MergedReflectivityQC*'.  Other members are passed over "
+        <<"unread"<<endl;
+    cout<<"    -field GLOB: convert only files whose header variable name "
+        <<"matches GLOB, e.g. 'CREF*'.  Only the header of other files "
+        <<"is read"<<endl;
+    cout<<"    -faa: write CF netCDF specifically for display by the FAA. This "
+        <<"adds a time dimension to the netCDF file, resulting in file dimensions "
+        <<"like... [time][nx][ny], where time's size is always 1"<<endl;
+    cout<<"    -sworigin: keep the rows in the input's order, southernmost "
+        <<"first, with an ascending Lat coordinate, instead of flipping "
+        <<"them to a NW origin.  Just as CF-compliant, and saves "
+        <<"reordering the data"<<endl;
+    cout<<"    -packed: write the data as stored, NC_SHORT with a CF "
+        <<"scale_factor of 1/scale and a short _FillValue, instead of "
+        <<"NC_FLOAT.  Half the size; CF readers see the same values.  "
+        <<"Products whose values are remapped are still written as "
+        <<"floats"<<endl;
+    cout<<"    -netcdf4: write netCDF-4 (HDF5, classic model) files whose "
+        <<"data variable is chunked and deflated in place, instead of "
+        <<"gzip'ing whole classic files.  Readers can then read one level "
+        <<"or region without inflating the file"<<endl;
+    cout<<"    -deflate N: netCDF-4 deflate level, 0 (none) to 9.  "
+        <<"Default: "<<format_defaults.deflateLevel<<endl;
+    cout<<"    -noshuffle: netCDF-4, no byte shuffle before deflate"<<endl;
+    cout<<"    -filter [GLOB=]SPEC: netCDF-4 (implied) compression filter "
+        <<"for the products (output names) matching GLOB, or all: "
+        <<"deflate[:LEVEL], zstd[:LEVEL], lz4[:BLOCK_BYTES], "
+        <<"blosc[:CODEC[:LEVEL[:none|byte|bit]]] (CODEC blosclz, lz4, "
+        <<"lz4hc, snappy, zlib or zstd; default lz4:5:bit), or an HDF5 "
+        <<"filter ID[:PARAM...].  Repeat for several product classes, "
+        <<"e.g. -filter 'MREFL*=blosc:zstd:3:bit' -filter zstd; the first "
+        <<"match is used.  Plugins are loaded from HDF5_PLUGIN_PATH; "
+        <<"readers need them too.  Default: deflate"<<endl;
+    cout<<"    -chunk ROWS COLS: netCDF-4 chunk shape within a level (0 = "
+        <<"the whole row or column).  Default: "<<format_defaults.chunkRows
+        <<" "<<format_defaults.chunkCols<<endl;
+
+}//end public method ConverterOptions::printUsage
+
+/***************************************/
+/** E N D  P U B L I C  M E T H O D S **/
+/***************************************/
+/***************************************/
+
+//End Class ConverterOptions
@@ -0,0 +1,77 @@
+#ifndef CONVERTEROPTIONS_H
+#define CONVERTEROPTIONS_H
+
+#include <string>
+#include <vector>
+
+#include "OutputFilter.h"
+
+using namespace std;
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	File:		ConverterOptions
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	Stores the command-line options of mrms_to_CFncdf
+	            that apply to every file converted
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+class ConverterOptions
+{
+  public:
+
+    int swapFlag;         //0, 1 or MRMS_SWAP_AUTO
+    bool faaCompliant;    //write the FAA display layout
+    bool swOrigin;        //keep the input's row order (no flip)
+    bool packed;          //write stored short ints, CF-packed
+
+    //netCDF-4 output, compressed in place (see OutputFormat.h)
+    bool netcdf4;
+    int deflateLevel;
+    bool shuffle;
+    int chunkRows, chunkCols;
+
+    //netCDF-4 compression filters by product: the first whose
+    //pattern (fnmatch, on the output variable name) matches
+    vector<string> filterPatterns;
+    vector<OutputFilter> filters;
+    int inflateBackend;   //see mrms_inflate.h
+    int simdIsa;          //see mrms_unscale.h
+    int numThreads;       //threads used to read and unscale each file
+    bool hugePages;       //transparent huge pages for data buffers
+    int queueDepth;       //directory files read ahead (0 = none)
+
+    //lat/lon box to crop the output to (degrees)
+    bool cropGrid;
+    float cropSouth, cropNorth, cropWest, cropEast;
+
+    //which files to convert (fnmatch patterns; empty = all): tar
+    //archive members by name, and any file by its header's
+    //variable name
+    string memberPattern;
+    string fieldPattern;
+
+
+    //default constructor
+    ConverterOptions();
+
+    //public methods
+    int parse(int argc, char* argv[], int first_arg);
+    void print() const;
+    const OutputFilter* filterFor(const string &product) const;
+
+    static void printUsage();
+
+};
+//end class ConverterOptions
+
+#endif
@@ -0,0 +1,258 @@
+#include <iostream>
+#include <vector>
+#include <string.h>
+
+#include "LevelSource.h"
+
+using namespace std;
+
+
+// C O N S T A N T S
+
+//fewest values worth handing to another thread (about 256 KB of
+//output); smaller levels are unscaled on the calling thread
+static const size_t MIN_BLOCK_VALUES = 65536;
+
+
+/*****************************/
+/*****************************/
+/** C O N S T R U C T O R S **/
+/*****************************/
+
+//constructor; the reader must already be open.  With whole_grid,
+//the file has been read whole into it and levels come from there.
+MrmsLevelSource::MrmsLevelSource(MrmsSlabReader &slab_reader,
+                                 MrmsGrid *whole_grid)
+  : slabs(slab_reader)
+{
+    grid = whole_grid;
+    simdIsa = mrms_simd_default();
+    threadPool = 0;
+    valueTable = 0;
+    flipRows = true;
+}
+
+/************************************/
+/** E N D  C O N S T R U C T O R S **/
+/************************************/
+/************************************/
+
+
+
+/********************************/
+/********************************/
+/** P U B L I C  M E T H O D S **/
+/********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		getLevel
+
+	Purpose:	Read the next level from the file, decode it and
+	            flip its origin to the NW corner (if flipRows).
+	            Without a value table the data are only unscaled.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int MrmsLevelSource::getLevel(int k, float *level_data)
+{
+    const short int *input = storedLevel(k);
+    if(input == 0) return -1;
+
+    const MrmsHeader &hdr = header();
+    ValueTable unscale_only(hdr.varScale);
+
+    unscaleFlip(input, level_data, hdr.nx, hdr.ny,
+                (valueTable != 0) ? *valueTable : unscale_only,
+                simdIsa, threadPool, flipRows);
+
+    return 1;
+
+}//end public method MrmsLevelSource::getLevel
+
+
+/*------------------------------------------------------------------
+
+	Method:		getPackedLevel
+
+	Purpose:	Read the next level from the file and hand it out
+	            as stored, its rows flipped in place to a NW
+	            origin (if flipRows).  No copy is made.
+
+	Output:		const short int* (0 on failure)
+
+------------------------------------------------------------------*/
+
+const short int* MrmsLevelSource::getPackedLevel(int k)
+{
+    short int *input = storedLevel(k);
+    if(input == 0) return 0;
+
+    if(flipRows) flipRowsInPlace(input, header().nx, header().ny);
+
+    return input;
+
+}//end public method MrmsLevelSource::getPackedLevel
+
+
+/*------------------------------------------------------------------
+
+	Method:		unscaleFlip
+
+	Purpose:	Unscale (or decode through the product's table)
+	            one level and flip its origin to be the NW (instead
+	            of SW) corner.  v1.1 mods here.  Each row is done
+	            whole by a vector kernel; unscaled output is
+	            bit-identical to (float)value / (float)var_scale.
+
+	            With a thread pool, the rows are cut into as many
+	            equal blocks as the pool has threads (fewer for
+	            small levels), by row number only, and each block
+	            is a task.  Rows are independent, so the output is
+	            the same for any number of threads.
+
+	Input:		input = ny*nx scaled values, SW origin
+	            values = the product's transform: var_scale, and
+	               any table
+	            isa = instruction set to use (see mrms_unscale.h)
+	            thread_pool = threads to use (0 = this one only)
+	            flip = false keeps the rows in input order (SW
+	               origin)
+
+	Output:		output = ny*nx unscaled values, NW origin (or SW)
+
+------------------------------------------------------------------*/
+
+void MrmsLevelSource::unscaleFlip(const short int *input, float *output,
+                                  int nx, int ny, const ValueTable &values,
+                                  int isa, ThreadPool *thread_pool,
+                                  bool flip)
+{
+    MrmsUnscale unscale;
+    mrms_unscale_setup(unscale, values.scale(), isa, (size_t)nx*ny,
+                       values.table());
+
+    size_t num_values = (size_t)nx*ny;
+    int num_blocks = 1;
+
+    if( (thread_pool != 0) && (ny > 1) )
+    {
+      num_blocks = thread_pool->threads();
+
+      if( (size_t)num_blocks > num_values / MIN_BLOCK_VALUES )
+        num_blocks = (int)(num_values / MIN_BLOCK_VALUES);
+      if(num_blocks > ny) num_blocks = ny;
+      if(num_blocks < 1) num_blocks = 1;
+    }
+
+    //block b is rows [ny*b/num_blocks, ny*(b+1)/num_blocks)
+    auto unscale_block = [&](int b)
+    {
+      int j_start = (int)( (long long)ny*b / num_blocks );
+      int j_end = (int)( (long long)ny*(b+1) / num_blocks );
+
+      for(int j = j_start; j < j_end; j++)
+      {
+        const short int *sw_row = input + (size_t)j*nx;
+        float *out_row = output + (size_t)(flip ? ny-j-1 : j)*nx;
+
+        mrms_unscale_row(unscale, sw_row, out_row, nx);
+
+      }//end j-loop
+    };
+
+    if(num_blocks == 1) unscale_block(0);
+    else thread_pool->run(num_blocks, unscale_block);
+
+}//end public method MrmsLevelSource::unscaleFlip
+
+
+/*------------------------------------------------------------------
+
+	Method:		flipRowsInPlace
+
+	Purpose:	Reverse the order of the ny rows of data, swapping
+	            the first with the last and so on
+
+------------------------------------------------------------------*/
+
+void MrmsLevelSource::flipRowsInPlace(short int *data, int nx, int ny)
+{
+    vector<short int> row(nx);
+    size_t row_bytes = (size_t)nx * sizeof(short int);
+
+    for(int j = 0; j < ny/2; j++)
+    {
+      short int *south = data + (size_t)j*nx;
+      short int *north = data + (size_t)(ny-j-1)*nx;
+
+      memcpy(row.data(), south, row_bytes);
+      memcpy(south, north, row_bytes);
+      memcpy(north, row.data(), row_bytes);
+
+    }//end j-loop
+
+}//end public method MrmsLevelSource::flipRowsInPlace
+
+/***************************************/
+/** E N D  P U B L I C  M E T H O D S **/
+/***************************************/
+/***************************************/
+
+
+
+/**********************************/
+/**********************************/
+/** P R I V A T E  M E T H O D S **/
+/**********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		storedLevel
+
+	Purpose:	Level k as stored in the file (SW origin): the next
+	            slab of the reader, or part of the whole grid
+
+	Output:		short int* (0 on failure, or if k is not the next
+	            level of a streamed file)
+
+------------------------------------------------------------------*/
+
+short int* MrmsLevelSource::storedLevel(int k)
+{
+    if(grid != 0)
+    {
+      const MrmsHeader &hdr = grid->header();
+      if( (k < 0) || (k >= hdr.nz) || (grid->data() == 0) ) return 0;
+
+      return grid->data() + (size_t)k*hdr.nx*hdr.ny;
+    }
+
+    if( (slabs.next() <= 0) || (slabs.level() != k) ) return 0;
+
+    return slabs.data();
+
+}//end private method MrmsLevelSource::storedLevel
+
+
+/*------------------------------------------------------------------
+
+	Method:		header
+
+	Purpose:	Header of the file the levels come from
+
+------------------------------------------------------------------*/
+
+const MrmsHeader& MrmsLevelSource::header() const
+{
+    if(grid != 0) return grid->header();
+    return slabs.header();
+
+}//end private method MrmsLevelSource::header
+
+/*****************************************/
+/** E N D  P R I V A T E  M E T H O D S **/
+/*****************************************/
+/*****************************************/
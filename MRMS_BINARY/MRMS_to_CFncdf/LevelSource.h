@@ -0,0 +1,101 @@
+#ifndef LEVELSOURCE_H
+#define LEVELSOURCE_H
+
+#include "MrmsGrid.h"
+#include "mrms_unscale.h"
+#include "ThreadPool.h"
+#include "ValueTable.h"
+
+using namespace std;
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	File:		LevelSource
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	LevelSource hands the netCDF writers the output
+	            data one level at a time, so neither the input nor
+	            the output cube is ever held whole in memory.  A
+	            level comes either decoded to floats, or packed:
+	            the stored short ints themselves, for writers that
+	            write them as they are (see OutputFormat).
+
+	            MrmsLevelSource supplies the levels of a MRMS file
+	            straight from an MrmsSlabReader (or from a grid
+	            already read whole).  Each level is decoded (see
+	            ValueTable) and flipped to a NW origin (unless
+	            setFlip(false)) into the writer's buffer, a row at
+	            a time with the vector kernels of mrms_unscale.
+	            Given a ThreadPool, big levels are cut into blocks
+	            of rows unscaled on the pool's threads.  Packed
+	            levels are handed out in the reader's own buffer,
+	            their rows swapped in place if flipped.
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+class LevelSource
+{
+  public:
+
+    //destructor
+    virtual ~LevelSource() { }
+
+    //fill level_data (ny*nx values, NW origin, or SW where the
+    //writer was told so) with level k.  Levels are asked for in
+    //order, lowest first.
+    virtual int getLevel(int k, float *level_data) = 0;
+
+    //level k as stored (ny*nx short ints, still scaled), in the
+    //same row order; valid until the next call.  0 on failure.
+    virtual const short int* getPackedLevel(int k) = 0;
+
+};
+//end class LevelSource
+
+
+
+class MrmsLevelSource : public LevelSource
+{
+  public:
+
+    //constructor
+    MrmsLevelSource(MrmsSlabReader &slab_reader, MrmsGrid *whole_grid = 0);
+
+    //public methods
+    int getLevel(int k, float *level_data);
+    const short int* getPackedLevel(int k);
+    void setSimd(int isa) { simdIsa = isa; }
+    void setThreadPool(ThreadPool *thread_pool) { threadPool = thread_pool; }
+    void setValueTable(const ValueTable *value_table) { valueTable = value_table; }
+    void setFlip(bool flip) { flipRows = flip; }
+
+    static void unscaleFlip(const short int *input, float *output,
+                            int nx, int ny, const ValueTable &values,
+                            int isa = mrms_simd_default(),
+                            ThreadPool *thread_pool = 0, bool flip = true);
+    static void flipRowsInPlace(short int *data, int nx, int ny);
+
+  private:
+
+    //levels come from grid when it is set, else from slabs
+    MrmsSlabReader &slabs;
+    MrmsGrid *grid;
+    int simdIsa;
+    ThreadPool *threadPool;
+    const ValueTable *valueTable;
+    bool flipRows;
+
+    short int* storedLevel(int k);
+    const MrmsHeader& header() const;
+
+};
+//end class MrmsLevelSource
+
+#endif
@@ -0,0 +1,193 @@
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+
+#include "OutputFilter.h"
+
+using namespace std;
+
+
+// C O N S T A N T S
+
+//Blosc's compressor codes and shuffle modes, in the order of the
+//filter's cd_values
+static const char* BLOSC_CODECS[] = { "blosclz", "lz4", "lz4hc", "snappy", "zlib", "zstd" };
+static const char* BLOSC_SHUFFLES[] = { "none", "byte", "bit" };
+
+//defaults: zstd level, and Blosc codec, level and shuffle
+static const unsigned int ZSTD_DEFAULT_LEVEL = 3;
+static const unsigned int BLOSC_DEFAULT_CODEC = 1;     //lz4
+static const unsigned int BLOSC_DEFAULT_LEVEL = 5;
+static const unsigned int BLOSC_DEFAULT_SHUFFLE = 2;   //bit
+
+
+
+/*****************************/
+/*****************************/
+/** C O N S T R U C T O R S **/
+/*****************************/
+
+//default constructor: deflate at the level -deflate sets
+OutputFilter::OutputFilter()
+{
+    filterId = DEFLATE;
+    spec = "deflate";
+}
+
+/************************************/
+/** E N D  C O N S T R U C T O R S **/
+/************************************/
+/************************************/
+
+
+
+/********************************/
+/********************************/
+/** P U B L I C  M E T H O D S **/
+/********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		parse
+
+	Purpose:	Set the filter from a spec (see OutputFilter.h).
+	            On failure the filter is left as it was.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int OutputFilter::parse(const string &filter_spec)
+{
+    //split at ':'
+    vector<string> fields;
+    stringstream in(filter_spec);
+    string field;
+    while(getline(in, field, ':')) fields.push_back(field);
+    if( fields.empty() || fields[0].empty() ) return -1;
+
+    //all but the name must be numbers, except Blosc's words
+    unsigned int new_id;
+    vector<unsigned int> new_params;
+    const string &filter_name = fields[0];
+
+    if(filter_name == "blosc")
+    {
+      if(fields.size() > 4) return -1;
+
+      unsigned int codec = BLOSC_DEFAULT_CODEC;
+      unsigned int level = BLOSC_DEFAULT_LEVEL;
+      unsigned int shuffle = BLOSC_DEFAULT_SHUFFLE;
+      size_t num_codecs = sizeof(BLOSC_CODECS) / sizeof(BLOSC_CODECS[0]);
+      size_t num_shuffles = sizeof(BLOSC_SHUFFLES) / sizeof(BLOSC_SHUFFLES[0]);
+
+      if(fields.size() > 1)
+      {
+        for(codec = 0; (codec < num_codecs) && (fields[1] != BLOSC_CODECS[codec]); codec++) { }
+        if(codec == num_codecs) return -1;
+      }
+      if(fields.size() > 2)
+      {
+        char *end;
+        level = strtoul(fields[2].c_str(), &end, 10);
+        if( fields[2].empty() || (*end != 0) || (level > 9) ) return -1;
+      }
+      if(fields.size() > 3)
+      {
+        for(shuffle = 0; (shuffle < num_shuffles) && (fields[3] != BLOSC_SHUFFLES[shuffle]); shuffle++) { }
+        if(shuffle == num_shuffles) return -1;
+      }
+
+      //the first four are filled in by the filter itself
+      new_id = BLOSC;
+      unsigned int blosc_params[7] = { 0, 0, 0, 0, level, shuffle, codec };
+      new_params.assign(blosc_params, blosc_params + 7);
+    }
+    else
+    {
+      for(size_t f = 1; f < fields.size(); f++)
+      {
+        char *end;
+        unsigned long value = strtoul(fields[f].c_str(), &end, 10);
+        if( fields[f].empty() || (*end != 0) ) return -1;
+        new_params.push_back( (unsigned int)value );
+      }
+
+      if(filter_name == "deflate")
+      {
+        new_id = DEFLATE;
+        if( (new_params.size() > 1) ||
+            ( !new_params.empty() && (new_params[0] > 9) ) ) return -1;
+      }
+      else if(filter_name == "zstd")
+      {
+        new_id = ZSTD;
+        if(new_params.size() > 1) return -1;
+        if(new_params.empty()) new_params.push_back(ZSTD_DEFAULT_LEVEL);
+      }
+      else if(filter_name == "lz4")
+      {
+        new_id = LZ4;
+        if(new_params.size() > 1) return -1;
+      }
+      else
+      {
+        char *end;
+        unsigned long value = strtoul(filter_name.c_str(), &end, 10);
+        if( (*end != 0) || (value == 0) ) return -1;
+        new_id = (unsigned int)value;
+      }
+    }
+
+    filterId = new_id;
+    filterParams = new_params;
+    spec = filter_spec;
+
+    return 1;
+
+}//end public method OutputFilter::parse
+
+
+/*------------------------------------------------------------------
+
+	Method:		name
+
+	Purpose:	The filter as given, and its HDF5 ID for plugins
+
+------------------------------------------------------------------*/
+
+string OutputFilter::name() const
+{
+    if( !plugin() ) return spec;
+
+    ostringstream out;
+    out<<spec<<" (HDF5 filter "<<filterId<<")";
+
+    return out.str();
+
+}//end public method OutputFilter::name
+
+
+/*------------------------------------------------------------------
+
+	Method:		deflateLevel
+
+	Purpose:	Level given with "deflate:LEVEL", or -1 if none
+	            (or not deflate)
+
+------------------------------------------------------------------*/
+
+int OutputFilter::deflateLevel() const
+{
+    if( plugin() || filterParams.empty() ) return -1;
+
+    return (int)filterParams[0];
+
+}//end public method OutputFilter::deflateLevel
+
+/***************************************/
+/** E N D  P U B L I C  M E T H O D S **/
+/***************************************/
+/***************************************/
+
+//End Class OutputFilter
@@ -0,0 +1,78 @@
+#ifndef OUTPUTFILTER_H
+#define OUTPUTFILTER_H
+
+#include <vector>
+#include <string>
+
+using namespace std;
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	File:		OutputFilter
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	The compression filter of the data variable of a
+	            netCDF-4 file: deflate (built in), or a registered
+	            HDF5 filter plugin given by ID and parameters
+	            (nc_def_var_filter).  Parsed from specs such as
+
+	              deflate[:LEVEL]
+	              zstd[:LEVEL]                       (ID 32015)
+	              lz4[:BLOCK_BYTES]                  (ID 32004)
+	              blosc[:CODEC[:LEVEL[:SHUFFLE]]]    (ID 32001)
+	                CODEC = blosclz, lz4, lz4hc, snappy, zlib, zstd
+	                SHUFFLE = none, byte, bit
+	              ID[:PARAM[:PARAM...]]              (any other)
+
+	            Plugin filters are found by the HDF5 library at run
+	            time (HDF5_PLUGIN_PATH); the writer falls back to
+	            deflate for a filter it cannot load.  Blosc
+	            shuffles within its own blocks; other plugins are
+	            preceded by netCDF's byte shuffle, if on.
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+class OutputFilter
+{
+  public:
+
+    //registered HDF5 filter IDs
+    static const unsigned int DEFLATE = 0;  //not a plugin: nc_def_var_deflate
+    static const unsigned int ZSTD = 32015;
+    static const unsigned int LZ4 = 32004;
+    static const unsigned int BLOSC = 32001;
+
+    //default constructor: deflate at the level -deflate sets
+    OutputFilter();
+
+
+    //public methods
+    int parse(const string &spec);
+    string name() const;
+
+    bool plugin() const { return (filterId != DEFLATE); }
+    bool ownShuffle() const { return (filterId == BLOSC); }
+
+    unsigned int id() const { return filterId; }
+    const vector<unsigned int>& params() const { return filterParams; }
+
+    //deflate's level, or -1 for the -deflate one
+    int deflateLevel() const;
+
+  private:
+
+    unsigned int filterId;
+    vector<unsigned int> filterParams;
+    string spec;
+
+};
+//end class OutputFilter
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef OUTPUTFORMAT_H
+#define OUTPUTFORMAT_H
+
+#include <cstddef>
+
+#include "OutputFilter.h"
+
+using namespace std;
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	File:		OutputFormat
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	How the CF netCDF writers lay out the data
+	            variable, beyond what the product decides: row
+	            order, whether values are written packed, and the
+	            file format.
+
+	            Packed data are the stored short ints themselves,
+	            written as NC_SHORT with the CF attributes
+	            scale_factor = 1/packScale and a short _FillValue,
+	            so readers that apply CF packing see the unscaled
+	            values.  The writer then takes each level straight
+	            from the input (LevelSource::getPackedLevel); no
+	            float copy is made.
+
+	            netCDF-4 files (HDF5, classic data model) are
+	            compressed in place: the data variable is stored in
+	            chunks of chunkRows x chunkCols cells of one level,
+	            each shuffled and deflated on its own.  Readers then
+	            read any level or region without inflating the rest
+	            of the file, so the file is not gzip'd.  Classic
+	            files are gzip'd whole as before.  Instead of
+	            deflate, chunks can go through an HDF5 filter
+	            plugin such as zstd, LZ4 or Blosc (see
+	            OutputFilter).
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+struct OutputFormat
+{
+    bool swOrigin;       //rows south to north (Lat ascending)
+    int packScale;       //> 0: write packed, scale_factor 1/packScale
+
+    //netCDF-4 storage of the data variable
+    bool netcdf4;        //netCDF-4 file instead of a gzip'd classic one
+    OutputFilter filter; //deflate, or an HDF5 filter plugin
+    int deflateLevel;    //0 (none) to 9, for deflate
+    bool shuffle;        //byte shuffle before deflate
+    size_t chunkRows;    //chunk shape within a level (cut to the
+    size_t chunkCols;    //grid; 0 = the whole row/column)
+
+    //default: NW origin, NC_FLOAT values, classic file
+    OutputFormat() : swOrigin(false), packScale(0), netcdf4(false),
+                     deflateLevel(4), shuffle(true),
+                     chunkRows(512), chunkCols(512) { }
+
+    bool packed() const { return (packScale > 0); }
+    size_t valueBytes() const { return packed() ? sizeof(short int) : sizeof(float); }
+};
+
+#endif
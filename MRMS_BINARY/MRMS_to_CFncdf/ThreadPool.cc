@@ -0,0 +1,218 @@
+#include <system_error>
+
+#include "ThreadPool.h"
+
+using namespace std;
+
+
+/*****************************/
+/*****************************/
+/** C O N S T R U C T O R S **/
+/*****************************/
+
+//default constructor
+ThreadPool::ThreadPool()
+{
+    numThreads = 1;
+    stopping = false;
+
+    job = 0;
+    numTasks = 0;
+    nextTask = 0;
+    unfinished = 0;
+}
+
+
+//destructor
+ThreadPool::~ThreadPool()
+{
+    stopWorkers();
+}
+
+/************************************/
+/** E N D  C O N S T R U C T O R S **/
+/************************************/
+/************************************/
+
+
+
+/********************************/
+/********************************/
+/** P U B L I C  M E T H O D S **/
+/********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		setThreads
+
+	Purpose:	Number of threads run uses, the caller's included
+	            (num_threads-1 workers are started).  If the system
+	            will not start that many, the pool keeps what it
+	            got.
+
+------------------------------------------------------------------*/
+
+void ThreadPool::setThreads(int num_threads)
+{
+    lock_guard< mutex > run_lock(runGuard);
+
+    if(num_threads < 1) num_threads = 1;
+    if(num_threads == numThreads) return;
+
+    stopWorkers();
+
+    try
+    {
+      for(int t = 1; t < num_threads; t++)
+        workers.push_back( thread( [this]() { work(); } ) );
+    }
+    catch(const system_error &)
+    {
+    }
+
+    numThreads = (int)workers.size() + 1;
+
+}//end public method ThreadPool::setThreads
+
+
+/*------------------------------------------------------------------
+
+	Method:		run
+
+	Purpose:	Call task(t) for t = 0 .. num_tasks-1, spread over
+	            the pool's threads, and wait for all of them.  The
+	            calling thread takes tasks too.
+
+------------------------------------------------------------------*/
+
+void ThreadPool::run(int num_tasks, const function<void(int)> &task)
+{
+    if(num_tasks <= 0) return;
+
+    lock_guard< mutex > run_lock(runGuard);
+
+    if( workers.empty() || (num_tasks == 1) )
+    {
+      for(int t = 0; t < num_tasks; t++) task(t);
+      return;
+    }
+
+    unique_lock< mutex > lock(guard);
+
+    job = &task;
+    numTasks = num_tasks;
+    nextTask = 0;
+    unfinished = num_tasks;
+    wake.notify_all();
+
+    while(nextTask < numTasks)
+    {
+      int t = nextTask++;
+
+      lock.unlock();
+      task(t);
+      lock.lock();
+
+      unfinished--;
+    }
+
+    finished.wait(lock, [this]() { return (unfinished == 0); });
+
+    job = 0;
+    numTasks = 0;
+    nextTask = 0;
+
+}//end public method ThreadPool::run
+
+
+/*------------------------------------------------------------------
+
+	Method:		shared
+
+	Purpose:	Pool shared by the whole process
+
+------------------------------------------------------------------*/
+
+ThreadPool& ThreadPool::shared()
+{
+    static ThreadPool pool;
+    return pool;
+
+}//end public method ThreadPool::shared
+
+/***************************************/
+/** E N D  P U B L I C  M E T H O D S **/
+/***************************************/
+/***************************************/
+
+
+
+/**********************************/
+/**********************************/
+/** P R I V A T E  M E T H O D S **/
+/**********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		work
+
+	Purpose:	Worker thread: take tasks of the current run until
+	            there are none left, then sleep until the next run
+	            (or stop)
+
+------------------------------------------------------------------*/
+
+void ThreadPool::work()
+{
+    unique_lock< mutex > lock(guard);
+
+    while(true)
+    {
+      wake.wait(lock, [this]() { return stopping || (nextTask < numTasks); });
+      if(stopping) return;
+
+      int t = nextTask++;
+      const function<void(int)> *task = job;
+
+      lock.unlock();
+      (*task)(t);
+      lock.lock();
+
+      if(--unfinished == 0) finished.notify_one();
+    }
+
+}//end private method ThreadPool::work
+
+
+/*------------------------------------------------------------------
+
+	Method:		stopWorkers
+
+	Purpose:	Stop and join every worker (no run may be in
+	            progress)
+
+------------------------------------------------------------------*/
+
+void ThreadPool::stopWorkers()
+{
+    {
+      lock_guard< mutex > lock(guard);
+      stopping = true;
+    }
+
+    wake.notify_all();
+
+    for(size_t w = 0; w < workers.size(); w++) workers[w].join();
+
+    workers.clear();
+    numThreads = 1;
+    stopping = false;
+
+}//end private method ThreadPool::stopWorkers
+
+/*****************************************/
+/** E N D  P R I V A T E  M E T H O D S **/
+/*****************************************/
+/*****************************************/
+
+//End Class ThreadPool
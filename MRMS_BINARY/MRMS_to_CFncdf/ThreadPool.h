@@ -0,0 +1,90 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	File:		ThreadPool
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	A fixed set of worker threads kept for the whole
+	            run, so work split per level (e.g. the unscale and
+	            flip of row blocks) does not start and join threads
+	            level after level.
+
+	            run(num_tasks, task) calls task(0) .. task(num_tasks-1)
+	            once each, on the workers and the calling thread,
+	            and returns when all are done.  Which thread runs a
+	            task is not fixed, so tasks must write disjoint
+	            output; how the work is cut into tasks is up to the
+	            caller and should not depend on timing.
+
+	            With setThreads(1) (or a single task) tasks run on
+	            the calling thread.  One run at a time; callers on
+	            other threads wait.  shared() is a pool for the
+	            whole process.
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+class ThreadPool
+{
+  public:
+
+    //default constructor (one thread: the caller's)
+    ThreadPool();
+
+    //destructor
+    ~ThreadPool();
+
+    //non-copyable
+    ThreadPool(const ThreadPool& pool) = delete;
+    ThreadPool& operator= (const ThreadPool& pool) = delete;
+
+
+    //public methods
+    void setThreads(int num_threads);
+    int threads() const { return numThreads; }
+
+    void run(int num_tasks, const function<void(int)> &task);
+
+    static ThreadPool& shared();
+
+
+  private:
+
+    mutex runGuard;                 //one run at a time
+    mutex guard;
+    condition_variable wake;        //workers: tasks posted, or stop
+    condition_variable finished;    //caller: last task done
+
+    vector<thread> workers;
+    int numThreads;
+    bool stopping;
+
+    //the run in progress
+    const function<void(int)> *job;
+    int numTasks;
+    int nextTask;
+    int unfinished;
+
+    void work();
+    void stopWorkers();
+
+};
+//end class ThreadPool
+
+#endif
@@ -0,0 +1,166 @@
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#include "ValueTable.h"
+
+using namespace std;
+
+
+// C O N S T A N T S
+
+//Units unitFactor knows, in meters.  Names are as they appear in
+//ProductInfo (input units are cut to 5 characters in the header).
+struct LengthUnit
+{
+    const char *name;
+    double meters;
+};
+
+static const LengthUnit LENGTH_UNITS[] =
+{
+    { "m", 1.0 }, { "mete", 1.0 }, { "meter", 1.0 }, { "meters", 1.0 },
+    { "km", 1000.0 }, { "kmAGL", 1000.0 }, { "kmMSL", 1000.0 },
+    { "kilometers", 1000.0 }
+};
+
+
+
+/*****************************/
+/*****************************/
+/** C O N S T R U C T O R S **/
+/*****************************/
+
+//constructor: unscale by var_scale only
+ValueTable::ValueTable(int var_scale)
+{
+    varScale = var_scale;
+    factor = 1.0;
+    outMissing = 0;
+}
+
+/************************************/
+/** E N D  C O N S T R U C T O R S **/
+/************************************/
+/************************************/
+
+
+
+/********************************/
+/********************************/
+/** P U B L I C  M E T H O D S **/
+/********************************/
+
+/*------------------------------------------------------------------
+
+	Method:		build
+
+	Purpose:	Work out the transform for product's data scaled by
+	            var_scale, whose header gives missing as the
+	            missing value.  Values are first unscaled exactly
+	            as before, (float)x / (float)var_scale, and that
+	            value picks out the sentinels.
+
+------------------------------------------------------------------*/
+
+void ValueTable::build(const ProductInfo &product, int var_scale, int missing)
+{
+    const float UNDEFINED = ProductInfo::UNDEFINED;
+
+    varScale = var_scale;
+    factor = unitFactor(product.varUnit, product.cfUnit);
+
+    bool remap_missing = (product.cfMissing != UNDEFINED);
+    bool remap_no_coverage = (product.cfNoCoverage != UNDEFINED);
+
+    outMissing = remap_missing ? product.cfMissing : (float)missing;
+
+    values.clear();
+    if( (factor == 1.0) && !remap_missing && !remap_no_coverage ) return;
+
+    values.resize(65536);
+
+    for(int x = -32768; x <= 32767; x++)
+    {
+      float value = (float)x / (float)var_scale;
+      float &out = values[ (unsigned short)x ];
+
+      if( (value == (float)missing) ||
+          ( (product.varMissing != UNDEFINED) && (value == product.varMissing) ) )
+        out = remap_missing ? product.cfMissing : value;
+      else if( (product.varNoCoverage != UNDEFINED) && (value == product.varNoCoverage) )
+        out = remap_no_coverage ? product.cfNoCoverage : value;
+      else if(factor != 1.0)
+        out = (float)( (double)x * factor / var_scale );
+      else
+        out = value;
+    }
+
+}//end public method ValueTable::build
+
+
+/*------------------------------------------------------------------
+
+	Method:		unitFactor
+
+	Purpose:	What values in from_unit are multiplied by to be in
+	            to_unit.  1 if the units are the same, or either is
+	            one this table does not know.
+
+------------------------------------------------------------------*/
+
+double ValueTable::unitFactor(const string &from_unit, const string &to_unit)
+{
+    double from_meters = 0, to_meters = 0;
+    size_t num_units = sizeof(LENGTH_UNITS) / sizeof(LENGTH_UNITS[0]);
+
+    for(size_t u = 0; u < num_units; u++)
+    {
+      if(from_unit == LENGTH_UNITS[u].name) from_meters = LENGTH_UNITS[u].meters;
+      if(to_unit == LENGTH_UNITS[u].name) to_meters = LENGTH_UNITS[u].meters;
+    }
+
+    if( (from_meters == 0) || (to_meters == 0) ) return 1.0;
+
+    return from_meters / to_meters;
+
+}//end public method ValueTable::unitFactor
+
+
+/*------------------------------------------------------------------
+
+	Method:		forProduct
+
+	Purpose:	The table for product, var_scale and missing, built
+	            the first time it is asked for and kept for the
+	            rest of the run.  The reference stays valid.
+
+------------------------------------------------------------------*/
+
+const ValueTable& ValueTable::forProduct(const ProductInfo &product,
+                                         int var_scale, int missing)
+{
+    static mutex guard;
+    static map<string, ValueTable> tables;
+
+    ostringstream key;
+    key<<product.varName<<" "<<product.varUnit<<" "<<var_scale<<" "<<missing;
+
+    lock_guard< mutex > lock(guard);
+
+    map<string, ValueTable>::iterator found = tables.find(key.str());
+    if(found != tables.end()) return found->second;
+
+    ValueTable &table = tables[key.str()];
+    table.build(product, var_scale, missing);
+
+    return table;
+
+}//end public method ValueTable::forProduct
+
+/***************************************/
+/** E N D  P U B L I C  M E T H O D S **/
+/***************************************/
+/***************************************/
+
+//End Class ValueTable
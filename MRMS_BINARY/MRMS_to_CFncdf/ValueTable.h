@@ -0,0 +1,80 @@
+#ifndef VALUETABLE_H
+#define VALUETABLE_H
+
+#include <vector>
+#include <string>
+
+#include "ProductInfo.h"
+
+using namespace std;
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	File:		ValueTable
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	How the stored (short int) values of a product
+	            become output values, from its ProductInfo entry:
+	             - unscaled by var_scale
+	             - missing (varMissing, or the header's missing
+	               value) and no coverage (varNoCoverage) cells
+	               set to cfMissing and cfNoCoverage, where those
+	               are defined; otherwise left as they are
+	             - other cells converted from varUnit to cfUnit
+	               (e.g. CREFH, m to kilometers)
+
+	            The input has only 65536 possible values, so when
+	            the transform is more than the scale the output of
+	            each is worked out once into a table, and levels
+	            are decoded by lookup (mrms_unscale_setup).  A
+	            plain scale needs no table: table() is 0 and the
+	            arithmetic kernels are used.
+
+	            forProduct() builds each product's table once and
+	            keeps it for the rest of the run.
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+class ValueTable
+{
+  public:
+
+    //constructor: unscale by var_scale only
+    ValueTable(int var_scale = 1);
+
+
+    //public methods
+    void build(const ProductInfo &product, int var_scale, int missing);
+
+    int scale() const { return varScale; }
+    const float* table() const { return values.empty() ? 0 : values.data(); }
+    bool plain() const { return values.empty(); }
+
+    //value of missing cells in the output, and the unit factor
+    float missingValue() const { return outMissing; }
+    double unitFactor() const { return factor; }
+
+    static double unitFactor(const string &from_unit, const string &to_unit);
+    static const ValueTable& forProduct(const ProductInfo &product,
+                                        int var_scale, int missing);
+
+  private:
+
+    int varScale;
+    double factor;
+    float outMissing;
+
+    //output by (unsigned short)input; empty = plain scale
+    vector<float> values;
+
+};
+//end class ValueTable
+
+#endif
@@ -0,0 +1,160 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "mrms_unscale.h"
+
+using namespace std;
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	Program:	bench_unscale.cc
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	Benchmark of the unscale-and-flip stage: the
+	            original loop (one float divide per cell, rows
+	            flipped from SW to NW origin) against the row
+	            kernels of mrms_unscale for each instruction set
+	            this CPU has.  Grids range from a CONUS level
+	            (7000 x 3500, streaming stores) down to a small
+	            one that stays in cache.
+
+	Input:		none
+
+	Output: 	Best time per grid in ms for each scale and kernel
+
+	To Compile:	make bench
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+
+/*------------------------------------------------------------------
+
+	Function:	reference_flip
+
+	Purpose:	The loop the kernels replaced
+
+------------------------------------------------------------------*/
+
+__attribute__((noinline))
+static void reference_flip(const short int *input, float *output,
+                           int nx, int ny, int var_scale)
+{
+    for(int j = 0; j < ny; j++)
+    {
+      const short int *sw_row = input + (size_t)j*nx;
+      float *nw_row = output + (size_t)(ny-j-1)*nx;
+
+      for(int i = 0; i < nx; i++)
+        nw_row[i] = (float)sw_row[i] / (float)var_scale;
+    }
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	kernel_flip
+
+	Purpose:	The same with mrms_unscale_row, as LevelSource
+	            does it
+
+------------------------------------------------------------------*/
+
+static void kernel_flip(const short int *input, float *output,
+                        int nx, int ny, int var_scale, int isa)
+{
+    MrmsUnscale unscale;
+    mrms_unscale_setup(unscale, var_scale, isa, (size_t)nx*ny);
+
+    for(int j = 0; j < ny; j++)
+      mrms_unscale_row(unscale, input + (size_t)j*nx,
+                       output + (size_t)(ny-j-1)*nx, nx);
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	best_time
+
+	Purpose:	Best of 3 runs of the average over num_reps
+	            unscales of the grid, with the reference loop
+	            (isa < 0) or a kernel
+
+	Output:		seconds
+
+------------------------------------------------------------------*/
+
+static double best_time(const vector<short int> &in, vector<float> &out,
+                        int nx, int ny, int var_scale, int isa, int num_reps)
+{
+    double best = 1e30;
+
+    for(int run = 0; run < 3; run++)
+    {
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+      for(int r = 0; r < num_reps; r++)
+      {
+        if(isa < 0) reference_flip(in.data(), out.data(), nx, ny, var_scale);
+        else kernel_flip(in.data(), out.data(), nx, ny, var_scale, isa);
+      }
+
+      chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+      if(elapsed.count()/num_reps < best) best = elapsed.count()/num_reps;
+    }
+
+    return best;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+    //nx, ny, repetitions
+    int grids[][3] = { {7000, 3500, 5}, {1000, 800, 50}, {256, 256, 2000},
+                       {70, 35, 20000} };
+    int scales[] = { 10, 1 };
+    int num_grids = sizeof(grids)/sizeof(grids[0]);
+
+    printf("best instruction set: %s\n", mrms_simd_name(mrms_simd_default()));
+
+    for(int g = 0; g < num_grids; g++)
+    {
+      int nx = grids[g][0], ny = grids[g][1], num_reps = grids[g][2];
+
+      vector<short int> in((size_t)nx*ny);
+      vector<float> out(in.size());
+
+      srand(1);
+      for(size_t v = 0; v < in.size(); v++)
+        in[v] = (short int)(rand() % 1400 - 999);
+
+      for(int s = 0; s < 2; s++)
+      {
+        printf("%5d x %-5d scale %-3d loop %8.3f ms", nx, ny, scales[s],
+               1e3*best_time(in, out, nx, ny, scales[s], -1, num_reps));
+
+        for(int isa = MRMS_SIMD_SCALAR; isa <= MRMS_SIMD_AVX512; isa++)
+        {
+          if( !mrms_simd_available(isa) ) continue;
+
+          printf("  %s %8.3f", mrms_simd_name(isa),
+                 1e3*best_time(in, out, nx, ny, scales[s], isa, num_reps));
+        }
+
+        printf("\n");
+      }
+    }
+
+    return 0;
+
+}//end main function
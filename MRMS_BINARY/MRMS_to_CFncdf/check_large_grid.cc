@@ -0,0 +1,367 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <unistd.h>
+#include <zlib.h>
+#include <netcdf.h>
+
+#include "func_prototype.h"
+#include "LevelSource.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	Program:	check_large_grid.cc
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	End-to-end check of grids of more than 2^31 cells
+	            (64-bit indexing, CDF-5 output).
+
+	            large_file_mode is first checked at the classic,
+	            64-bit offset and CDF-5 limits.  Then a synthetic
+	            7000 x 3500 x 88 cube (2.16 billion cells, 4.3 GB
+	            of data; the gzip ISIZE wraps past 4 GiB) is
+	            written gzip'd to the scratch directory, its last
+	            level read on its own (MrmsGrid::readLevels), and
+	            the cube converted the way mrms_to_CFncdf does it:
+	            MrmsSlabReader -> MrmsLevelSource (unscale and
+	            flip) -> write_CF_netCDF_3d, not gzip'd.  The
+	            output must be CDF-5, and rows of the first,
+	            middle and last levels read back with netCDF must
+	            hold the expected values.
+
+	            Needs about 9 GB free in the scratch directory
+	            and a netCDF library with CDF-5 (4.4 or later).
+
+	Input:		optional: scratch directory (default /tmp), and
+	            number of levels (default 88)
+
+	Output: 	One line per check; exit status 1 on failure
+
+	To Compile:	make check-large (builds and runs it)
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+
+// C O N S T A N T S
+
+static const int NX = 7000;
+static const int NY = 3500;
+static const int VAR_SCALE = 10;
+
+
+/*------------------------------------------------------------------
+
+	Function:	stored_value
+
+	Purpose:	The synthetic int16 value of column i, row j (row
+	            0 = south, as stored) of level k
+
+------------------------------------------------------------------*/
+
+static inline short int stored_value(int i, int j, int k)
+{
+    return (short int)( (i/16 + 3*(j/16) + 5*k) % 400 );
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	put_int
+
+	Purpose:	Append a little-endian 4-byte int
+
+------------------------------------------------------------------*/
+
+static void put_int(vector<unsigned char> &buf, int value)
+{
+    for(int b = 0; b < 4; b++)
+      buf.push_back( (unsigned char)(((unsigned int)value >> 8*b) & 0xff) );
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	write_input
+
+	Purpose:	Write the synthetic cube as a gzip'd little-endian
+	            MRMS binary file, a level at a time
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+static int write_input(const string &vfname, int nz)
+{
+    vector<unsigned char> hdr;
+
+    int date_time[6] = { 2026, 10, 17, 12, 0, 0 };
+    for(int i = 0; i < 6; i++) put_int(hdr, date_time[i]);
+    put_int(hdr, NX);  put_int(hdr, NY);  put_int(hdr, nz);
+    put_int(hdr, 0);                                       //projection
+    put_int(hdr, 1000);                                    //map scale
+    for(int i = 0; i < 3; i++) put_int(hdr, 0);            //trulats, trulon
+    put_int(hdr, -130000);  put_int(hdr, 55000);           //NW lon, lat
+    put_int(hdr, 0);                                       //xy scale
+    put_int(hdr, 10);  put_int(hdr, 10);  put_int(hdr, 1000);  //dx, dy
+    for(int k = 0; k < nz; k++) put_int(hdr, 250*(k+1));
+    put_int(hdr, 1);                                       //z scale
+    for(int i = 0; i < 10; i++) put_int(hdr, 0);           //placeholders
+
+    char name[20] = "MergedReflectivity", unit[6] = "dBZ";
+    hdr.insert(hdr.end(), name, name + 20);
+    hdr.insert(hdr.end(), unit, unit + 6);
+    put_int(hdr, VAR_SCALE);  put_int(hdr, -999);  put_int(hdr, 0);
+
+    gzFile gz = gzopen(vfname.c_str(), "wb1");
+    if(gz == 0) return -1;
+
+    bool ok = (gzwrite(gz, hdr.data(), hdr.size()) == (int)hdr.size());
+
+    vector<short int> level((size_t)NX*NY);
+    for(int k = 0; ok && (k < nz); k++)
+    {
+      for(int j = 0; j < NY; j++)
+        for(int i = 0; i < NX; i++)
+          level[(size_t)j*NX + i] = stored_value(i, j, k);
+
+      unsigned int level_bytes = level.size()*sizeof(short int);
+      ok = (gzwrite(gz, level.data(), level_bytes) == (int)level_bytes);
+    }
+
+    if( (gzclose(gz) != Z_OK) || !ok ) return -1;
+
+    return 1;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	check_modes
+
+	Purpose:	large_file_mode at the format limits
+
+	Output:		number of wrong modes
+
+------------------------------------------------------------------*/
+
+static int check_modes()
+{
+    struct { size_t bytes; int mode; int want; } cases[] = {
+      { ((size_t)1 << 31) - 4, NC_CLOBBER,      NC_CLOBBER },
+      { ((size_t)1 << 31),     NC_CLOBBER,      NC_64BIT_OFFSET },
+      { ((size_t)1 << 31),     NC_64BIT_OFFSET, NC_64BIT_OFFSET },
+      { ((size_t)1 << 32) - 4, NC_64BIT_OFFSET, NC_64BIT_OFFSET },
+      { ((size_t)1 << 32),     NC_CLOBBER,      NC_64BIT_DATA },
+      { ((size_t)1 << 32),     NC_64BIT_OFFSET, NC_64BIT_DATA },
+      { (size_t)NX*NY*88*sizeof(float), NC_64BIT_OFFSET, NC_64BIT_DATA } };
+    int num_cases = sizeof(cases)/sizeof(cases[0]);
+
+    int num_bad = 0;
+    for(int c = 0; c < num_cases; c++)
+    {
+      if(large_file_mode(cases[c].bytes, cases[c].mode) != cases[c].want)
+      {
+        printf("large_file_mode(%zu, %d) is not %d\n", cases[c].bytes,
+               cases[c].mode, cases[c].want);
+        num_bad++;
+      }
+    }
+
+    return num_bad;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	check_output
+
+	Purpose:	Read the first, middle and last rows of levels 0,
+	            nz/2 and nz-1 back from the netCDF file and check
+	            them (NW origin: output row r is stored row
+	            NY-1-r)
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+static int check_output(const string &vfname, const string &var_name, int nz)
+{
+    int file_handle, var_id, format, ndims;
+
+    if( nc_open(vfname.c_str(), NC_NOWRITE, &file_handle) != NC_NOERR )
+    {
+      printf("cannot open %s\n", vfname.c_str());
+      return -1;
+    }
+
+    int status = 1;
+
+    if( (nc_inq_format(file_handle, &format) != NC_NOERR) ||
+        (format != NC_FORMAT_CDF5) )
+    {
+      printf("output is not CDF-5\n");
+      status = -1;
+    }
+
+    if( (nc_inq_varid(file_handle, var_name.c_str(), &var_id) != NC_NOERR) ||
+        (nc_inq_varndims(file_handle, var_id, &ndims) != NC_NOERR) ||
+        (ndims < 3) || (ndims > 4) )
+    {
+      printf("no 3D variable %s in the output\n", var_name.c_str());
+      nc_close(file_handle);
+      return -1;
+    }
+
+    int levels[3] = { 0, nz/2, nz-1 };
+    int rows[3] = { 0, NY/2, NY-1 };
+    vector<float> row(NX);
+    long num_bad = 0;
+
+    for(int l = 0; l < 3; l++)
+      for(int r = 0; r < 3; r++)
+      {
+        //[time,] level, row, column
+        size_t start[4] = {0, 0, 0, 0}, count[4] = {1, 1, 1, 1};
+        start[ndims-3] = levels[l];
+        start[ndims-2] = rows[r];
+        count[ndims-1] = NX;
+
+        if( nc_get_vara_float(file_handle, var_id, start, count, row.data())
+            != NC_NOERR )
+        {
+          num_bad += NX;
+          continue;
+        }
+
+        for(int i = 0; i < NX; i++)
+        {
+          float want = (float)stored_value(i, NY-1-rows[r], levels[l]) /
+                       (float)VAR_SCALE;
+          if(row[i] != want) num_bad++;
+        }
+      }
+
+    nc_close(file_handle);
+
+    if(num_bad > 0)
+    {
+      printf("%ld values read back are wrong\n", num_bad);
+      status = -1;
+    }
+
+    return status;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+    string scratch = (argc > 1) ? argv[1] : "/tmp";
+    int nz = (argc > 2) ? atoi(argv[2]) : 88;
+
+    if(nz < 1)
+    {
+      cout<<"Usage:  check_large_grid [scratch_dir [num_levels]]"<<endl;
+      exit(1);
+    }
+
+    size_t num_cells = (size_t)NX*NY*nz;
+    string input_file = scratch + "/check_large_grid.bin.gz";
+    string output_file = scratch + "/check_large_grid.netcdf";
+    int status = 0;
+
+
+    //1. Output modes
+    int modes_bad = check_modes();
+    printf("large_file_mode: %d wrong\n", modes_bad);
+    if(modes_bad > 0) status = 1;
+
+
+    //2. Input
+    printf("writing %d x %d x %d = %zu cells (%s 2^31) to %s\n", NX, NY, nz,
+           num_cells, (num_cells > (size_t)INT_MAX) ? "over" : "NOT over",
+           input_file.c_str());
+
+    if( write_input(input_file, nz) < 0 )
+    {
+      cout<<"+++ERROR: Could not write "<<input_file<<endl;
+      exit(1);
+    }
+
+
+    //3. Last level on its own, from past the 4 GiB mark of the stream
+    MrmsGrid grid;
+    long level_bad = 0;
+
+    if( grid.readLevels(input_file.c_str(), MRMS_SWAP_AUTO, nz-1, 1) < 0 )
+    {
+      printf("readLevels: %s\n", grid.errorMessage().c_str());
+      level_bad = 1;
+    }
+    else
+    {
+      for(int j = 0; j < NY; j++)
+        for(int i = 0; i < NX; i++)
+          if(grid.data()[(size_t)j*NX + i] != stored_value(i, j, nz-1))
+            level_bad++;
+    }
+
+    printf("last level read alone: %ld wrong\n", level_bad);
+    if(level_bad > 0) status = 1;
+    grid.clear();
+
+
+    //4. Conversion, as mrms_to_CFncdf does it
+    MrmsSlabReader slabs;
+    if( slabs.open(input_file.c_str(), MRMS_SWAP_AUTO) < 0 )
+    {
+      cout<<"+++ERROR: "<<slabs.errorMessage()<<endl;
+      unlink(input_file.c_str());
+      exit(1);
+    }
+
+    const MrmsHeader &hdr = slabs.header();
+    string var_name = hdr.varName;
+    vector<float> heights = hdr.zhgt;
+
+    MrmsLevelSource levels(slabs);
+    levels.setThreadPool(&ThreadPool::shared());
+
+    int write_status = write_CF_netCDF_3d(output_file, "LatLonHeightGrid",
+                         var_name, var_name, hdr.varUnit,
+                         hdr.nx, hdr.ny, hdr.nz, hdr.dx, hdr.dy,
+                         hdr.nwLat, hdr.nwLon, heights.data(),
+                         hdr.epochSeconds, 0.0f, -999.0f, -99900.0f,
+                         levels, 0);
+    slabs.close();
+    unlink(input_file.c_str());
+
+    if(write_status < 0)
+    {
+      printf("write_CF_netCDF_3d failed\n");
+      status = 1;
+    }
+    else if( check_output(output_file, var_name, nz) < 0 )
+      status = 1;
+    else
+      printf("conversion: CDF-5 output, values read back match\n");
+
+    unlink(output_file.c_str());
+
+    return status;
+
+}//end main function
@@ -0,0 +1,169 @@
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+
+#include "mrms_unscale.h"
+
+using namespace std;
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	Program:	check_unscale.cc
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	Check the unscale kernels (mrms_unscale) against
+	            (float)x / (float)scale, bit for bit.  For every
+	            instruction set this CPU has and a range of
+	            scales, all 65536 short int values are run through
+	            mrms_unscale_row in rows of odd lengths.  Successive
+	            rows start at each float offset within a 64-byte
+	            line in turn (so vector bodies, aligning heads and
+	            scalar tails are all reached), with regular and
+	            streaming stores, and through a lookup table.  The
+	            floats around each row are checked for stray
+	            writes.
+
+	Input:		none
+
+	Output: 	One line per instruction set; exit status 1 if
+	            any value differs
+
+	To Compile:	make check (builds and runs it)
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+
+//floats written before and after each row, and what they hold
+static const size_t GUARD = 32;
+static const uint32_t GUARD_BITS = 0x7fc0dead;
+
+
+/*------------------------------------------------------------------
+
+	Function:	check_rows
+
+	Purpose:	Unscale all of in (every short int value) in rows
+	            of row_len values, and compare with expect.  Row r
+	            is written (first_offset + 5r) mod 16 floats past
+	            a 64-byte boundary.
+
+	Output:		number of values (or guard floats) that differ
+
+------------------------------------------------------------------*/
+
+static size_t check_rows(const MrmsUnscale &unscale,
+                         const vector<short int> &in,
+                         const vector<uint32_t> &expect,
+                         size_t row_len, size_t first_offset,
+                         vector<float> &out_buf)
+{
+    size_t num_bad = 0;
+
+    //64-byte aligned start inside out_buf
+    uintptr_t base = (uintptr_t)out_buf.data();
+    float *aligned = out_buf.data() + ((64 - (base & 63)) & 63)/sizeof(float);
+
+    for(size_t first = 0, row = 0; first < in.size(); first += row_len, row++)
+    {
+      size_t n = (first + row_len <= in.size()) ? row_len : in.size() - first;
+      float *out = aligned + GUARD + (first_offset + 5*row) % 16;
+
+      uint32_t *bits = reinterpret_cast< uint32_t * >( out - GUARD );
+      for(size_t i = 0; i < n + 2*GUARD; i++) bits[i] = GUARD_BITS;
+
+      mrms_unscale_row(unscale, &in[first], out, n);
+
+      for(size_t i = 0; i < n + 2*GUARD; i++)
+      {
+        bool in_row = (i >= GUARD) && (i < GUARD + n);
+        uint32_t want = in_row ? expect[first + i - GUARD] : GUARD_BITS;
+
+        if(bits[i] != want) num_bad++;
+      }
+    }
+
+    return num_bad;
+}
+
+
+
+int main(int argc, char *argv[])
+{
+    int scales[] = { 1, 2, 3, 7, 10, 16, 20, 25, 50, 100, 1000, 10000,
+                     32767, -10 };
+    size_t row_lens[] = { 1, 3, 7, 15, 17, 31, 33, 63, 65, 127, 1001, 65535 };
+    int num_scales = sizeof(scales)/sizeof(scales[0]);
+    int num_lens = sizeof(row_lens)/sizeof(row_lens[0]);
+
+    //every short int value
+    vector<short int> in(65536);
+    for(int x = -32768; x <= 32767; x++) in[x+32768] = (short int)x;
+
+    vector<float> out_buf(in.size() + 2*GUARD + 64);
+    vector<float> table(65536);
+    vector<uint32_t> expect(in.size());
+
+    int status = 0;
+
+    for(int isa = MRMS_SIMD_SCALAR; isa <= MRMS_SIMD_AVX512; isa++)
+    {
+      if( !mrms_simd_available(isa) )
+      {
+        printf("%-7s not supported by this CPU\n", mrms_simd_name(isa));
+        continue;
+      }
+
+      size_t num_checked = 0, num_bad = 0;
+
+      for(int s = 0; s < num_scales; s++)
+      {
+        for(size_t v = 0; v < in.size(); v++)
+        {
+          float want = (float)in[v] / (float)scales[s];
+          memcpy(&expect[v], &want, sizeof(float));
+          table[(unsigned short)in[v]] = want;
+        }
+
+        //arithmetic with regular and streaming stores, then lookup
+        for(int pass = 0; pass < 3; pass++)
+        {
+          MrmsUnscale unscale;
+          mrms_unscale_setup(unscale, scales[s], isa, in.size(),
+                             (pass == 2) ? table.data() : 0);
+          unscale.stream = (pass == 1);
+
+          for(int l = 0; l < num_lens; l++)
+          {
+            size_t bad = check_rows(unscale, in, expect, row_lens[l],
+                                    (size_t)l, out_buf);
+            if( (bad > 0) && (num_bad == 0) )
+              printf("%-7s scale %d %s rows of %zu: %zu wrong\n",
+                     mrms_simd_name(isa), scales[s],
+                     (pass == 0) ? "stores" :
+                     (pass == 1) ? "streaming" : "lookup",
+                     row_lens[l], bad);
+
+            num_bad += bad;
+            num_checked += in.size();
+          }
+        }
+      }
+
+      printf("%-7s %zu values checked, %zu wrong\n", mrms_simd_name(isa),
+             num_checked, num_bad);
+      if(num_bad > 0) status = 1;
+    }
+
+    return status;
+
+}//end main function
@@ -6,19 +6,16 @@
 
 #include "ProductInfo.h"
 #include "HeaderAttribute.h"
+#include "mrms_binary_reader.h"
+#include "mrms_inflate.h"
+#include "LevelSource.h"
+#include "OutputFormat.h"
 
 using namespace std;
 
 vector<ProductInfo> setupMRMS_ProductRefData( );
                    
-short int* mrms_binary_reader_cart3d(const char *vfname,                     
-                     char *varname, char *varunit,
-                     int &nradars, vector<string> &radarnam,
-                     int &var_scale, int &missing_val,
-                     float &nw_lon, float &nw_lat,
-                     int &nx, int &ny, float &dx, float &dy,
-                     float zhgt[], int &nz, long &epoch_seconds,
-                     int swap_flag);
+//MRMS binary reader: see MrmsGrid.h and mrms_binary_reader.h
                    
 int write_CF_netCDF_2d( string outputfile, string dataType, 
                    string longName, string varName, string varUnit,
@@ -28,7 +25,8 @@ int write_CF_netCDF_2d( string outputfile, string dataType,
                    string cf_time_string, long cf_fcst_length,
                    vector<HeaderAttribute>& attrs, 
                    float missing_value, float range_folded_value,
-                   float* data_1D, int gzip_flag);
+                   LevelSource &levels, int gzip_flag,
+                   const OutputFormat &format = OutputFormat());
                    
 int write_CF_netCDF_2d_FAA( string outputfile, string dataType, 
                    string longName, string varName, string varUnit,
@@ -38,7 +36,8 @@ int write_CF_netCDF_2d_FAA( string outputfile, string dataType,
                    string cf_time_string, long cf_fcst_length,
                    vector<HeaderAttribute>& attrs, 
                    float missing_value, float range_folded_value,
-                   float* data_1D, int gzip_flag);
+                   LevelSource &levels, int gzip_flag,
+                   const OutputFormat &format = OutputFormat());
                    
 int write_CF_netCDF_3d( string outputfile, string dataType, 
                    string longName, string varName, string varUnit,
@@ -46,7 +45,8 @@ int write_CF_netCDF_3d( string outputfile, string dataType,
                    float nw_lat, float nw_lon, float heights[],
                    long epoch_time, float fractional_time,
                    float missing_value, float range_folded_value,
-                   float* data_1D, int gzip_flag );
+                   LevelSource &levels, int gzip_flag,
+                   const OutputFormat &format = OutputFormat() );
                                       
 int write_CF_netCDF_3d_FAA( string outputfile, string dataType, 
                    string longName, string varName, string varUnit,
@@ -54,11 +54,21 @@ int write_CF_netCDF_3d_FAA( string outputfile, string dataType,
                    float nw_lat, float nw_lon, float heights[],
                    long epoch_time, float fractional_time,
                    float missing_value, float range_folded_value,
-                   float* data_1D, int gzip_flag );
+                   LevelSource &levels, int gzip_flag,
+                   const OutputFormat &format = OutputFormat() );
 
 void check_err(const int stat, const int line, const char *file);
 int soft_check_err_wrt(const int stat, const int line, const char *file); 
 int write_extra_attributes(int file_handle, int varID, vector<HeaderAttribute>& attrs);
+int large_file_mode(size_t var_bytes, int mode);
+int create_mode(size_t var_bytes, int mode, const OutputFormat &format);
+int define_storage(int file_handle, int varID, int ndims, int nx, int ny,
+                   const OutputFormat &format);
+int write_fill_value(int file_handle, int varID, float missing_value,
+                     const OutputFormat &format);
+int write_levels(int file_handle, int varID, int ndims, int level_dim,
+                 int nx, int ny, int nz, LevelSource &levels,
+                 const OutputFormat &format);
 
 #endif
 
@@ -0,0 +1,347 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include "mrms_deflate.h"
+
+using namespace std;
+
+
+// C O N S T A N T S
+
+//bytes read from the file, and buffered by zlib, at a time (serial)
+static const size_t GZIP_BLOCK_BYTES = 1 << 20;
+
+//parallel: bytes of input compressed by each task, and how much of
+//the input before a block primes its dictionary (deflate's window)
+static const size_t PARALLEL_BLOCK_BYTES = 128 << 10;
+static const size_t DICTIONARY_BYTES = 32 << 10;
+
+//parallel: blocks read (and held, with their output) per run of the
+//pool, per thread
+static const int BLOCKS_PER_THREAD = 4;
+
+
+// F U N C T I O N S
+
+/*------------------------------------------------------------------
+
+	Function:	write_all
+
+	Purpose:	write(2) all num_bytes of data, however many calls
+	            that takes
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+static int write_all(int fd, const void *data, size_t num_bytes)
+{
+    const char *next = (const char*)data;
+
+    while(num_bytes > 0)
+    {
+      ssize_t num_written = write(fd, next, num_bytes);
+
+      if(num_written < 0)
+      {
+        if(errno == EINTR) continue;
+        return -1;
+      }
+
+      next += num_written;
+      num_bytes -= (size_t)num_written;
+    }
+
+    return 1;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	read_all
+
+	Purpose:	read(2) num_bytes into data, however many calls
+	            that takes
+
+	Output:		int indicating success (1) or failure (-1, also if
+	            the file ends first)
+
+------------------------------------------------------------------*/
+
+static int read_all(int fd, void *data, size_t num_bytes)
+{
+    char *next = (char*)data;
+
+    while(num_bytes > 0)
+    {
+      ssize_t num_read = read(fd, next, num_bytes);
+
+      if(num_read < 0)
+      {
+        if(errno == EINTR) continue;
+        return -1;
+      }
+      if(num_read == 0) return -1;
+
+      next += num_read;
+      num_bytes -= (size_t)num_read;
+    }
+
+    return 1;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	gzip_serial
+
+	Purpose:	Compress the open file fd into gz_name through
+	            gzwrite, a block at a time
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+static int gzip_serial(int fd, const string &gz_name, int level)
+{
+    char mode[8];
+    sprintf(mode, "wb%d", level);
+
+    gzFile gz = gzopen(gz_name.c_str(), mode);
+    if(gz == 0) return -1;
+    gzbuffer(gz, GZIP_BLOCK_BYTES);
+
+    vector<char> block(GZIP_BLOCK_BYTES);
+    bool failed = false;
+
+    while(!failed)
+    {
+      ssize_t num_read = read(fd, block.data(), block.size());
+
+      if(num_read < 0)
+      {
+        if(errno == EINTR) continue;
+        failed = true;
+      }
+      else if(num_read == 0) break;
+      else if(gzwrite(gz, block.data(), (unsigned)num_read) != (int)num_read)
+        failed = true;
+    }
+
+    if( (gzclose(gz) != Z_OK) || failed ) return -1;
+
+    return 1;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	deflate_block
+
+	Purpose:	Raw-deflate one block of input into out, primed
+	            with dict (the input just before it, if any).  All
+	            blocks but the file's last end in a sync flush (byte
+	            aligned, not final), so the outputs of consecutive
+	            blocks joined together are one deflate stream.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+static int deflate_block(const unsigned char *in, size_t in_bytes,
+                         const unsigned char *dict, size_t dict_bytes,
+                         bool last, int level, vector<unsigned char> &out)
+{
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+
+    if(deflateInit2(&strm, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+      return -1;
+
+    if( (dict_bytes > 0) &&
+        (deflateSetDictionary(&strm, dict, (uInt)dict_bytes) != Z_OK) )
+    {
+      deflateEnd(&strm);
+      return -1;
+    }
+
+    //room for all of it, plus the sync flush's empty stored block
+    out.resize(deflateBound(&strm, in_bytes) + 16);
+
+    strm.next_in = (Bytef*)in;
+    strm.avail_in = (uInt)in_bytes;
+    strm.next_out = out.data();
+    strm.avail_out = (uInt)out.size();
+
+    int stat = deflate(&strm, last ? Z_FINISH : Z_SYNC_FLUSH);
+    bool done = last ? (stat == Z_STREAM_END) :
+                       ( (stat == Z_OK) && (strm.avail_in == 0) && (strm.avail_out > 0) );
+
+    out.resize(out.size() - strm.avail_out);
+    deflateEnd(&strm);
+
+    return done ? 1 : -1;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	gzip_parallel
+
+	Purpose:	Compress the open file fd, file_bytes long, into
+	            gz_name as one gzip member, pigz-style: the input
+	            is cut into blocks deflated on thread_pool, each
+	            primed with the 32 KB of input before it, and the
+	            outputs are written in order between one gzip
+	            header and trailer (CRCs combined).  Batches of
+	            blocks are read, compressed and written in turn.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+static int gzip_parallel(int fd, size_t file_bytes, const string &gz_name,
+                         int level, ThreadPool &thread_pool)
+{
+    int out_fd = open(gz_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if(out_fd < 0) return -1;
+
+    //gzip header as zlib writes it: no name or time, Unix
+    unsigned char header[10] = { 0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 3 };
+    if(level == 9) header[8] = 2;
+    else if(level == 1) header[8] = 4;
+
+    bool failed = (write_all(out_fd, header, sizeof(header)) < 0);
+
+    size_t num_blocks = (file_bytes + PARALLEL_BLOCK_BYTES - 1) / PARALLEL_BLOCK_BYTES;
+    if(num_blocks == 0) num_blocks = 1;  //an empty file still needs a final block
+
+    size_t batch_blocks = (size_t)thread_pool.threads() * BLOCKS_PER_THREAD;
+    vector<unsigned char> input(batch_blocks * PARALLEL_BLOCK_BYTES);
+    vector< vector<unsigned char> > output(batch_blocks);
+    vector<uLong> crcs(batch_blocks);
+    vector<int> status(batch_blocks);
+
+    //the input just before the current batch
+    vector<unsigned char> dictionary;
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+
+    for(size_t first = 0; (first < num_blocks) && !failed; first += batch_blocks)
+    {
+      size_t num_batch = min(batch_blocks, num_blocks - first);
+      size_t batch_start = first * PARALLEL_BLOCK_BYTES;
+      size_t batch_bytes = min(num_batch * PARALLEL_BLOCK_BYTES, file_bytes - batch_start);
+
+      if( (batch_bytes > 0) && (read_all(fd, input.data(), batch_bytes) < 0) )
+      {
+        failed = true;
+        break;
+      }
+
+      thread_pool.run( (int)num_batch, [&](int b)
+      {
+        size_t start = (size_t)b * PARALLEL_BLOCK_BYTES;
+        size_t in_bytes = min(PARALLEL_BLOCK_BYTES, batch_bytes - start);
+        const unsigned char *in = input.data() + start;
+
+        const unsigned char *dict = in - min(start, DICTIONARY_BYTES);
+        size_t dict_bytes = min(start, DICTIONARY_BYTES);
+        if(b == 0)
+        {
+          dict = dictionary.data();
+          dict_bytes = dictionary.size();
+        }
+
+        crcs[b] = crc32(crc32(0L, Z_NULL, 0), in, (uInt)in_bytes);
+        status[b] = deflate_block(in, in_bytes, dict, dict_bytes,
+                                  (first + b + 1 == num_blocks), level, output[b]);
+      });
+
+      for(size_t b = 0; (b < num_batch) && !failed; b++)
+      {
+        size_t in_bytes = min(PARALLEL_BLOCK_BYTES, batch_bytes - b*PARALLEL_BLOCK_BYTES);
+
+        if( (status[b] < 0) ||
+            (write_all(out_fd, output[b].data(), output[b].size()) < 0) )
+          failed = true;
+
+        crc = crc32_combine(crc, crcs[b], (z_off_t)in_bytes);
+      }
+
+      size_t dict_bytes = min(batch_bytes, DICTIONARY_BYTES);
+      dictionary.assign(input.data() + batch_bytes - dict_bytes,
+                        input.data() + batch_bytes);
+    }
+
+    //trailer: CRC-32 and length mod 2^32, little endian
+    unsigned char trailer[8];
+    for(int i = 0; i < 4; i++)
+    {
+      trailer[i] = (unsigned char)( (crc >> (8*i)) & 0xff );
+      trailer[4+i] = (unsigned char)( (file_bytes >> (8*i)) & 0xff );
+    }
+    if( !failed && (write_all(out_fd, trailer, sizeof(trailer)) < 0) ) failed = true;
+
+    if( (close(out_fd) < 0) || failed ) return -1;
+
+    return 1;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	mrms_gzip_file
+
+	Purpose:	Compress fname into fname.gz, in parallel if given
+	            a pool of more than one thread and more than one
+	            block of input, then remove fname
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int mrms_gzip_file(const char *fname, int level, ThreadPool *thread_pool)
+{
+    string gz_name = string(fname) + ".gz";
+
+    int fd = open(fname, O_RDONLY);
+    struct stat st;
+
+    if( (fd < 0) || (fstat(fd, &st) < 0) )
+    {
+      cout<<"+++ERROR: Cannot open "<<fname<<" to gzip it: "<<strerror(errno)<<endl;
+      if(fd >= 0) close(fd);
+      return -1;
+    }
+
+    size_t file_bytes = (size_t)st.st_size;
+    bool parallel = (thread_pool != 0) && (thread_pool->threads() > 1) &&
+                    (file_bytes > PARALLEL_BLOCK_BYTES);
+
+    int status = parallel ?
+      gzip_parallel(fd, file_bytes, gz_name, level, *thread_pool) :
+      gzip_serial(fd, gz_name, level);
+
+    close(fd);
+    if(status < 0)
+    {
+      cout<<"+++ERROR: Failed to gzip "<<fname<<endl;
+      unlink(gz_name.c_str());
+      return -1;
+    }
+
+    unlink(fname);
+
+    return 1;
+
+}//end function mrms_gzip_file
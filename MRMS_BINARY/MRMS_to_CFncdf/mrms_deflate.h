@@ -0,0 +1,49 @@
+#ifndef MRMS_DEFLATE_H
+#define MRMS_DEFLATE_H
+
+#include "ThreadPool.h"
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	File:		mrms_deflate
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	gzip the converter's output files in process, the
+	            counterpart of mrms_inflate.  The finished netCDF
+	            is streamed through zlib into <file>.gz, which
+	            then replaces it, as "gzip -f" did, without a shell
+	            and gzip process per file.
+
+	            Given a ThreadPool of more than one thread, big
+	            files are compressed pigz-style: the input is cut
+	            into 128 KB blocks deflated on the pool's threads,
+	            each primed with the 32 KB of input before it (so
+	            compression is about as good as serial), and
+	            joined, sync-flushed, into a single standard gzip
+	            member with one CRC-32.  Any gunzip reads it.
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+
+// C O N S T A N T S
+
+//gzip's default level
+static const int MRMS_GZIP_LEVEL = 6;
+
+
+// F U N C T I O N  P R O T O T Y P E S
+
+//compress fname into fname.gz (replacing any), on thread_pool's
+//threads if given, then remove fname.  Returns 1 on success, -1 on
+//failure (fname is then left as it was, and no fname.gz)
+int mrms_gzip_file(const char *fname, int level = MRMS_GZIP_LEVEL,
+                   ThreadPool *thread_pool = 0);
+
+#endif
@@ -1,591 +1,1133 @@
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <vector>
-#include <string>
-#include <string.h>
-#include <dirent.h>
-#include <cstdlib>
-
-#include "ProductInfo.h"
-#include "HeaderAttribute.h"
-#include "func_prototype.h"
-
-using namespace std;   
-
-/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
-
-	Program:	MRMS_to_CFncdf
-	
-	Date:		July 2013
-	
-	Author:		Carrie Langston (CIMMS/NSSL)
-	        	
-	Purpose:	This program will read in a MRMS binary file
-			write it to CF-compliant netCDF.  Various command-line
-			options allow the user to address little vs big endian
-			problems and choose between a FAA specific CF-netCDF.
-		
-	Input:		command-line arguments and options:
-			1) input file name
-			2) output path
-			3) options
-			   -swap: data is switching between little and big
-			      endian systems.  Apply a byte swap when reading
-			      input files
-			   -faa: write data for FAA display, which requires a
-			      time dimension be added to the netCDF file.  This
-			      results in file dimensions like... [time][nx][ny],
-			      where time's size is always 1
-					     
-	                  
-	Output: 	CF-compliant netCDF
-				
-				
-	To Compile:	Use make.  
-			Should result in executable called mrms_to_CFncdf
-	           	
-	To Run:	mrms_to_CFncdf <input path/file> <output path> [opitons]
-																											
-	_____________________________________________________________			
-	Modification History:
-	
-	8/29/2013  Carrie Langston (CIMMS/NSSL)  v1.1
-	- Turns out that folks don't like their data flipped upside down.
-	Thus, the output grids have been reorganized to write in the
-	the correct order.
-
-	10/23/2013  Carrie Langston (CIMMS/NSSL)  v1.2
-	- Fixed sometimes erroneous calculation of epoch seconds when
-	reading MRMS binary intput
-
-	11/05/2013  Carrie Langston (CIMMS/NSSL)  v1.2.1
-        - Added reference data entry for converting Stage IV 1h QPE
-
-	06/01/2017  Carrie Langston (CIMMS/NSSL)  v1.2.2
-        - Updated reference data entry for brightband top/bottom
-
-	09/11/2017  Carrie Langston (CIMMS/NSSL)  v1.2.3
-        - Added reference data entry for converting mosaics of 
-        Kdp, RhoHV, Spectrumwidth, Zdr
-        - Changed product type string from "NMQ Product" to 
-        "MRMS Product"
-
-	09/09/2021  Carrie Langston (CIMMS/NSSL)  v1.2.4
-        - Added Evap Corr and MS QPE entries
-
-%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
-
-
-/************************************************/
-/***  F U N C T I O N  P R O T O T Y P E (S)  ***/
-/************************************************/
-
-vector<ProductInfo> setupMRMS_ProductRefData( );
-                   
-string stripSpaces(string in);
-
-int productKnown(const char *varname, const char *varunit,
-                 vector<ProductInfo>& pInfo);
-
-//also see func_prototype.h
-
-
-
-/********************************/
-/***  M A I N  P R O G R A M  ***/
-/********************************/
-
-int main(int argc,  char* argv[])
-{
-    cout<<"\n\n"<<endl;
-    cout<<"      *************************************************"<<endl;
-    cout<<"      *                                               *"<<endl;
-    cout<<"      *       WELCOME TO MRMS->CFNCDF CONVERTER       *"<<endl;
-    cout<<"      *              v1.2.4 09/09/2021                *"<<endl;
-    cout<<"      *                                               *"<<endl;
-    cout<<"      *************************************************"<<endl;
-    cout<<endl;
-    
-
-
-    /*---------------------------------------*/
-    /*** 0. Process command-line arguments ***/ 
-    /*---------------------------------------*/
-
-    //Process command-line arguments
-    if( argc < 3 )
-    {
-      cout<<"Usage:  mrms_to_CFncdf [input file] [output path] (options)"<<endl;
-      cout<<"  [input file]: full path and filename of input file"<<endl;
-      cout<<"  [output path]: top level output directory for netCDF"<<endl;
-      cout<<"  (optional arguments)"<<endl;
-      cout<<"    -swap: turns on byte swapping when reading input files.  This is "
-          <<"needed when data is written on a system with a different endian than the "
-          <<"system running this converter (little vs. big)."<<endl;
-      cout<<"    -faa: write CF netCDF specifically for display by the FAA. This "
-          <<"adds a time dimension to the netCDF file, resulting in file dimensions "
-          <<"like... [time][nx][ny], where time's size is always 1"<<endl;
-
-      cout<<"Exiting from mrms_to_CFncdf"<<endl<<endl;
-      exit(0);
-    }
-    
-    string input_file = argv[1];
-    string output_path = argv[2];
-    
-    
-    string option1, option2;
-    if( argc > 3 ) option1 = argv[3];
-    if( argc < 4 ) option2 = argv[4];
-    
-    
-    bool swapflag = false, faa_compliant = false;
-    if( (option1 == "-swap") || (option2 == "-swap") ) swapflag = true;
-    if( (option1 == "-faa") || (option2 == "-faa") )   faa_compliant = true;
-    
-    cout<<"Swap flag for little vs. big endian is ";
-    if(swapflag) cout<<"on"<<endl;
-    else cout<<"off"<<endl;
-    
-    if(faa_compliant) 
-      cout<<"Output will be FAA display compliant"<<endl;
-    
-    cout<<endl;
-    
-    
-    
-    /*---------------------------------------*/
-    /*** 1. Read in product reference data ***/
-    /*---------------------------------------*/
-
-    vector<ProductInfo> productInfo;
-    productInfo = setupMRMS_ProductRefData( );
-    
-    if(productInfo.size() < 1)
-    {
-      cout<<"+++ERROR: Failed to setup product reference information from. Exiting!"
-          <<endl<<endl;
-      exit(0);
-    }
-    
-        
-
-    /*----------------------------------------*/
-    /*** 2. Read input file and error check ***/
-    /*----------------------------------------*/
-    
-    //Declare some reusable variables
-    char varname[20];
-    char prev_varname[20];
-    char varunit[6];
-    int nradars;
-    vector<string> radarnames;
-    int var_scale, missing;
-    float nw_lat, nw_lon;
-    int nx, ny, nz;
-    float dx, dy;
-    float zhgt[50]; //assume there will be <50 levels <- BAD PRACTICE!
-    long epoch_sec;
-    short int* input_data_1D = 0;
-    float* input_data_1D_FLOAT = 0;
-        
-    int pIndex = -1;
-    strcpy(prev_varname, "");
-    
-    
-    cout<<" Processing: "<<input_file<<endl;
-      
-      
-    /*** 2A. Read file header and data ***/
-      
-    input_data_1D = mrms_binary_reader_cart3d(input_file.c_str(),                     
-                           varname, varunit,
-                           nradars, radarnames,
-                           var_scale, missing,
-                           nw_lon, nw_lat,
-                           nx, ny, dx, dy,
-                           zhgt, nz, epoch_sec, swapflag);
-      
-    //Error checking
-    if(input_data_1D == 0)
-    {
-      cout<<"+++ERROR: Failed to read "<<input_file<<" Exiting!"<<endl;
-      exit(0);
-
-    }
-    else if( (nx < 1) || (ny < 1) || (nz < 1) )
-    {
-      cout<<"+++ERROR: Dimensions bad for "<<input_file<<" Exiting!"<<endl;
-      delete [] input_data_1D;
-      input_data_1D = 0;
-      exit(0);
-
-    }
-     
-    cout<<" DONE reading file"<<endl;
-      
-      
-    /*** 2B. Check if entry for data field exists in product ref data ***/
-     
-    //Remove any spaces in variable name. Replace with underscore
-    string tmpstr = stripSpaces( (string)varname);
-    strcpy(varname, tmpstr.c_str());      
-
-    //Remove any spaces in variable unit. Replace with underscore
-    //cout<<"VarUnit b4: >"<<varunit<<"<"<<endl;
-    tmpstr = stripSpaces( (string)varunit);
-    strcpy(varunit, tmpstr.c_str());      
-    //cout<<"VarUnit aft: >"<<varunit<<"<"<<endl;
-
-    //If previous and current file contain the same type of data
-    //field, then no need to search for product info again.
-    //If different, then search
-    if(strcmp(varname, prev_varname) != 0)
-    {
-      pIndex = productKnown(varname, varunit, productInfo);
-    }
-      
-    if(pIndex < 0)
-    {
-      cout<<"+++ERROR: Data field (name="<<varname<<", unit="<<varunit
-          <<") not found in product reference info"<<endl;
-      delete [] input_data_1D;
-      input_data_1D = 0;
-      exit(0);            
-    }
-      
-      
-    /*** 2C. Helpful print statement ***/
-      
-    //Print out header info.
-    cout<<endl<<" Binary Header Info:"<<endl;
-    cout<<"  variable name = "<<varname<<endl;
-    cout<<"  variable unit = "<<varunit<<endl;
-    cout<<"  number of radars = "<<nradars<<endl;
-    
-    cout<<"  Radars: ";
-    for(size_t i = 0; i < radarnames.size(); i++)
-      cout<<radarnames[i]<<" ";
-    cout<<endl;
-    
-    cout<<"  variable scale = "<<var_scale<<endl;
-    cout<<"  missing value = "<<missing<<endl;
-    cout<<"  NW latitude = "<<nw_lat<<endl;
-    cout<<"  NW longitude = "<<nw_lon<<endl;
-    cout<<"  Number of columns = "<<nx<<endl;
-    cout<<"  Number of rows = "<<ny<<endl;
-    cout<<"  Number of levels = "<<nz<<endl;
-    cout<<"  Grid cell size (degree lat.) = "<<dy<<endl;
-    cout<<"  Grid cell size (degree lon.) = "<<dx<<endl;
-    cout<<"  Number of vertical levels = "<<nz<<endl;
-    
-    cout<<"  Level heights = ";
-    for(int i = 0; i < nz; i++) cout<<zhgt[i]<<" ";
-    cout<<endl;
-    
-    char timestamp[20];
-    strftime(timestamp, 20, "%m/%d/%Y %H%M", gmtime(&epoch_sec));
-    cout<<"  Time = "<<timestamp<<" UTC  (or "<<epoch_sec
-        <<" epoch seconds)"<<endl<<endl;
-          
-    //cout<<"  Will map missing values to "<<productInfo[pIndex].w2Missing<<endl;
-    //cout<<"  Will map no coverage values to "<<productInfo[pIndex].w2NoCoverage<<endl;
-      
-            
-      
-    /*------------------------*/
-    /*** 3. Write CF netCDF ***/
-    /*------------------------*/
-
-      
-    /*** 3A. Prep for file output (header) ***/
-    
-    //bookkeeping
-    int status = 0;
-    
-    //file names and system commands
-    char output_path_fname[500];
-    char system_command[500];
-    
-    vector<HeaderAttribute> attrs; //keep empty
-      
-    long fcstTime = (long)productInfo[pIndex].fcstTime;
-    string dataType = productInfo[pIndex].cfName;
-    string longName = productInfo[pIndex].cfLongName;
-    string varName = productInfo[pIndex].cfName;
-    string varUnit = productInfo[pIndex].cfUnit;
-    if(varUnit == "none") varUnit.clear();
-      
-    //Set time parameters for valid time. Take forecast products into account.
-    string cf_time_string;
-    long cf_fcst_length;
-    
-    if(fcstTime > 0)
-    {
-      //If product is a forecast
-      char tmp_cf_time_string[50];
-      strftime(tmp_cf_time_string, 50,
-             "seconds since %Y-%m-%d %H:%M:%S", gmtime(&epoch_sec));
-      cf_time_string = tmp_cf_time_string;
-      cf_fcst_length = fcstTime;
-    }
-    else
-    {
-      //If product is NOT a forecast, then set time parameters 
-      //for valid time
-      cf_time_string = "seconds since 1970-1-1 0:0:0";
-      cf_fcst_length = epoch_sec;  
-    }
-
-      
-      
-    //Data time info
-    strftime (timestamp, 20, "%Y%m%d-%H%M%S", gmtime(&epoch_sec));    
-    float fractional_time = 0.0; //milliseconds
-    
-    
-    //Check for special case where output path should include subdir
-    //based on height of field (e.g., mrefl_levels)
-    bool wrtSubDir = false;
-    char sub_dir[20];
-
-    if( (nz == 1) && 
-        ( (varName == "MREFL") || (varName == "MKDP") || (varName == "MRHOHV") || (varName == "MSPW") || (varName == "MZDR") ) )
-    {
-      cout<<"Looks like we're converting 2D slices of 3D reflectivity. "
-          <<"Writing output to height-based subdirectories."<<endl;
-      wrtSubDir = true;
-    
-      if(zhgt[0] < 1000)
-        sprintf(sub_dir, "0%.2f", (zhgt[0]/1000.0));
-      else if(zhgt[0] < 10000)
-        sprintf(sub_dir, "0%.2f", (zhgt[0]/1000.0));
-      else
-        sprintf(sub_dir, "%.2f", (zhgt[0]/1000.0));    
-    }
-          
-          
-    //Build output file name and
-    //Build mkdir command and execute (for output directory)
-    // structure:  [top dir]/[product]
-    //  subproduct = height level
-    if(wrtSubDir)
-    {
-      sprintf(output_path_fname, "%s/%s/%s/%s.netcdf", output_path.c_str(),
-                           varName.c_str(), sub_dir, timestamp);
-      sprintf(system_command, "mkdir -p %s/%s/%s", 
-             output_path.c_str(), varName.c_str(), sub_dir);
-    }
-    else
-    {
-      sprintf(output_path_fname, "%s/%s/%s.netcdf", output_path.c_str(),
-                           varName.c_str(), timestamp);
-      sprintf(system_command, "mkdir -p %s/%s", 
-             output_path.c_str(), varName.c_str());    
-    }
-
-    //cout<<" Making: "<<system_command<<endl;
-    system(system_command);
-          
-          
-      
-    int gzip_flag = 1; //on
-    float range_folded_value = missing -1;
-      
-    
-      
-    /*** 3B. Prep for file output (data) ***/
-    
-    int num = nx*ny*nz;
-    input_data_1D_FLOAT = new float [num];
-      
-    //unscale and flip orgin to be NW (instead of SW) corner.
-    //v1.1 mods here.
-    int sw_origin_index, nw_origin_index;
-    int k_size;
-    for(int k = 0; k < nz; k++)
-    {
-      k_size = k*nx*ny;
-       
-      for(int j = 0; j < ny; j++)
-      {
-        sw_origin_index = k_size + j*nx;
-        nw_origin_index = k_size + (ny-j-1)*nx;
-        
-        for(int i = 0; i < nx; i++)
-        {
-          sw_origin_index++;  
-          nw_origin_index++;
-          
-          input_data_1D_FLOAT[nw_origin_index] 
-              = (float)input_data_1D[sw_origin_index] / (float)var_scale;
-          
-        }//end i-loop
-      }//end j-loop
-    }//end k-loop
-      
-
-      
-    /*** 3C. Determine if 2D or 3D data.  Call correct output function ***/
-    if(nz > 1)
-    {
-      if( faa_compliant )
-      {
-        cout<<" Writing 3D file (compliant with FAA display requirements)."<<endl;
-        status = write_CF_netCDF_3d_FAA( (string)output_path_fname, 
-                     dataType, longName, varName, varUnit,  
-                     nx, ny, nz, dx, dy, nw_lat, nw_lon, zhgt,
-                     epoch_sec, fractional_time,
-                     missing, range_folded_value,
-                     input_data_1D_FLOAT, gzip_flag);
-      }
-      else
-      {
-        cout<<" Writing 3D file."<<endl;
-        status = write_CF_netCDF_3d( (string)output_path_fname, 
-                     dataType, longName, varName, varUnit,  
-                     nx, ny, nz, dx, dy, nw_lat, nw_lon, zhgt,
-                     epoch_sec, fractional_time,
-                     missing, range_folded_value,
-                     input_data_1D_FLOAT, gzip_flag);
-      }
-      
-    }
-    else
-    {
-      if( faa_compliant )
-      {
-        cout<<" Writing 2D file (compliant with FAA display requirements)."<<endl;
-        status = write_CF_netCDF_2d_FAA( (string)output_path_fname, 
-                     dataType, longName, varName, varUnit,  
-                     nx, ny, dx, dy, nw_lat, nw_lon, zhgt[0],
-                     epoch_sec, fractional_time, cf_time_string, 
-                     cf_fcst_length, attrs, missing, range_folded_value,
-                     input_data_1D_FLOAT, gzip_flag);
-               
-      }
-      else
-      {
-        cout<<" Writing 2D file."<<endl;
-        status = write_CF_netCDF_2d( (string)output_path_fname, 
-                     dataType, longName, varName, varUnit,  
-                     nx, ny, dx, dy, nw_lat, nw_lon, zhgt[0],
-                     epoch_sec, fractional_time, cf_time_string, 
-                     cf_fcst_length, attrs, missing, range_folded_value,
-                     input_data_1D_FLOAT, gzip_flag);
-               
-      }
-        
-    }//end if-blk (nz > 1)
-      
-      
-    if(status > 0)
-    {
-      cout<<" Output is "<<output_path_fname;
-      if(gzip_flag) cout<<".gz"<<endl;
-      else cout<<endl;
-    }
-      
-    cout<<" DONE writing"<<endl<<endl;
-          
-
-    
-    /*------------------------*/
-    /*** 4. Free-up Memory, ***/
-    /*------------------------*/
-
-    //memory clean-up
-    if(input_data_1D_FLOAT != 0) delete [] input_data_1D_FLOAT;
-    if(input_data_1D != 0) delete [] input_data_1D;
-                
-
-    cout<<"CONVERTER DONE."<<endl<<endl;
-    return 1;
-    
-}//end main function
-
-
-
-
-/**************************/
-/*** F U N C T I O N S  ***/
-/**************************/
-
-//also see mrms_binary_reader.cc, write_CF_netCDF_2d.cc, write_CF_netCDF_2d_FAA.cc,
-// write_CF_netCDF_3d.cc, write_CF_netCDF_3d_FAA.cc
-
-string stripSpaces(string in)
-{
-    string out = in;
-    size_t length;
-  
-    while(out.find(" ") != string::npos)
-    {
-      length = out.length();
-      
-      if( (out.find(" ") == 0) && (length > 1) )
-      {
-        out = out.substr(1);
-      }
-      else if( (out.find(" ") == (length-1)) && 
-               (length > 1) )
-      {
-        out = out.substr(0, (length-1));
-      }
-      else if(length <= 1)
-      {
-        out.clear();
-      }
-      else
-      {  
-        out[out.find(" ")] = '_';
-      }
-       
-    }//end while-loop
-    
-    //the loop above may result in extra leading or ending underscores.
-    //e.g., when there are more than one leading or ending spaces
-    //undo the damage here. 
-    while(out.find("_") != string::npos)
-    {      
-      if(out.rfind("_") == 0)
-        out = out.substr(1);  
-      else break;      
-    }
-
-    while(out.rfind("_") != string::npos)
-    {
-      length = out.length();
-      
-      if(out.rfind("_") == (length-1))
-        out = out.substr(0, (length-1));
-      else break;
-    }
-           
-    return out;
-  
-}//end function stripSpaces
-
-
-
-int productKnown(const char *varname, const char *varunit, 
-                 vector<ProductInfo>& pInfo)
-{
-    string pName = varname;
-    string pUnit = varunit;
-    
-    if(pName.empty()) return -1;
-    //if(pUnit.empty()) return -1;
-    
-    
-    for(size_t p = 0; p < pInfo.size(); p++)
-    {
-      if( pInfo[p].isMatch( pName, pUnit ) )  return p;
-      
-    }//end p-loop
-    
-    return -1;
-
-}//end functio productKnown
-                 
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <string.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <set>
+#include <mutex>
+
+#include "ProductInfo.h"
+#include "HeaderAttribute.h"
+#include "ConverterOptions.h"
+#include "MrmsTarReader.h"
+#include "MrmsFileQueue.h"
+#include "MrmsGzIndex.h"
+#include "ThreadPool.h"
+#include "ValueTable.h"
+#include "func_prototype.h"
+
+using namespace std;   
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	Program:	MRMS_to_CFncdf
+	
+	Date:		July 2013
+	
+	Author:		Carrie Langston (CIMMS/NSSL)
+	        	
+	Purpose:	This program will read in a MRMS binary file
+			write it to CF-compliant netCDF.  Various command-line
+			options allow the user to address little vs big endian
+			problems and choose between a FAA specific CF-netCDF.
+		
+	Input:		command-line arguments and options:
+			1) input file name, or a directory of input files.
+			   Tar archives (.tar, .tar.gz, .tgz) are read in
+			   place, converting each member
+			2) output path
+			3) options
+			   -swap: data is switching between little and big
+			      endian systems.  Apply a byte swap when reading
+			      input files.  Without -swap or -noswap the byte
+			      order is detected from each file's header
+			   -noswap: never byte swap
+			   -inflate zlib|libdeflate: how gzip'd input is
+			      decompressed (default: fastest one built in)
+			   -simd scalar|sse2|avx2|avx512: instruction set
+			      used to unscale data (default: widest one)
+			   -threads N: threads used to unscale data, and to
+			      inflate input that has a random-access index
+			      (<file>.gzidx)
+			   -bbox S N W E: crop the output to a lat/lon box
+			   -hugepages: put data buffers on transparent huge
+			      pages
+			   -member GLOB: convert only archive members whose
+			      names match GLOB
+			   -field GLOB: convert only files whose header
+			      variable name matches GLOB
+			   -queue N: read up to N files of a directory ahead
+			      (io_uring); 0 reads each file when it is needed
+			   -faa: write data for FAA display, which requires a
+			      time dimension be added to the netCDF file.  This
+			      results in file dimensions like... [time][nx][ny],
+			      where time's size is always 1
+			   -sworigin: keep the input's SW origin (rows south
+			      to north, Lat ascending) instead of flipping to
+			      a NW origin
+			   -packed: write the stored short ints (NC_SHORT)
+			      with a CF scale_factor instead of floats
+			   -netcdf4: write netCDF-4 files, chunked and
+			      deflated in place, instead of gzip'd classic
+			      files.  -deflate N, -noshuffle and
+			      -chunk ROWS COLS set how
+			   -filter [GLOB=]SPEC: netCDF-4 output compressed
+			      with an HDF5 filter (zstd, lz4, blosc, ...)
+			      for products matching GLOB
+					     
+	                  
+	Output: 	CF-compliant netCDF
+				
+				
+	To Compile:	Use make.  
+			Should result in executable called mrms_to_CFncdf
+	           	
+	To Run:	mrms_to_CFncdf <input path/file> <output path> [opitons]
+																											
+	_____________________________________________________________			
+	Modification History:
+	
+	8/29/2013  Carrie Langston (CIMMS/NSSL)  v1.1
+	- Turns out that folks don't like their data flipped upside down.
+	Thus, the output grids have been reorganized to write in the
+	the correct order.
+
+	10/23/2013  Carrie Langston (CIMMS/NSSL)  v1.2
+	- Fixed sometimes erroneous calculation of epoch seconds when
+	reading MRMS binary intput
+
+	11/05/2013  Carrie Langston (CIMMS/NSSL)  v1.2.1
+        - Added reference data entry for converting Stage IV 1h QPE
+
+	06/01/2017  Carrie Langston (CIMMS/NSSL)  v1.2.2
+        - Updated reference data entry for brightband top/bottom
+
+	09/11/2017  Carrie Langston (CIMMS/NSSL)  v1.2.3
+        - Added reference data entry for converting mosaics of 
+        Kdp, RhoHV, Spectrumwidth, Zdr
+        - Changed product type string from "NMQ Product" to 
+        "MRMS Product"
+
+	09/09/2021  Carrie Langston (CIMMS/NSSL)  v1.2.4
+        - Added Evap Corr and MS QPE entries
+
+	10/17/2026  CIMMS/NSSL  v1.3.0
+        - Read input through the MrmsGrid class shared with
+        MRMS_CartBinaryReader.  Removed the 50 level limit.
+        - Byte order is detected from each file's header unless
+        -swap/-noswap is given.  Input may be a directory; files
+        are converted in one pass, skipping any that fail.
+        - Fixed parsing of the second command-line option
+        - Added -inflate option.  gzip'd input can be inflated in
+        one call with libdeflate (see Makefile)
+        - Added -threads option.  Input with a random-access index
+        is inflated in parallel.  Options moved to ConverterOptions
+        - 3D data is streamed one level at a time from the input to
+        the netCDF writer (MrmsSlabReader/LevelSource), so memory use
+        no longer grows with the number of levels.  Fixed the flip
+        loop, which shifted every row by one column
+        - Added -bbox option to convert only a lat/lon box.  Cells
+        outside it are dropped as the input is inflated
+        - Data buffers come from a pool (MrmsBufferPool) reused from
+        file to file.  Added -hugepages option
+        - The reader keeps no static state and returns its errors
+        as messages, printed here.  gmtime_r instead of gmtime
+        - Grids of more than 4 GiB are written as CDF-5
+        (NC_64BIT_DATA); all data indexing is 64-bit
+        - Tar archives are converted member by member in one pass,
+        without extracting them (MrmsTarReader).  Added -member and
+        -field options to choose members by name or by variable
+        - Files of a directory are read ahead, several at a time,
+        through io_uring (MrmsFileQueue) and decoded from memory.
+        Added -queue option
+        - Data is unscaled a row at a time by SSE2/AVX2/AVX-512
+        kernels chosen at run time (mrms_unscale), bit-identical to
+        the scalar loop.  Added -simd option
+        - Unscale and flip of big levels is split into row blocks
+        run on a pool of -threads threads (ThreadPool)
+        - Values are decoded through a 64K-entry table per product
+        (ValueTable) where the product needs more than unscaling:
+        sentinels mapped to cfMissing/cfNoCoverage when those are
+        defined, and units converted (CREFH and LCREFH, m to km)
+        - Added -sworigin option: rows are written in the input's
+        order with an ascending Lat, skipping the flip
+        - Added -packed option: data are written as NC_SHORT with
+        scale_factor 1/var_scale straight from the input buffer.
+        2D data now also go to the writers through LevelSource
+        - Added -netcdf4 option (with -deflate, -noshuffle, -chunk):
+        netCDF-4 output with the data variable chunked, shuffled and
+        deflated in place instead of gzip'ing the whole file
+        - Output directories are made in process (and remembered),
+        and output gzip'd through zlib (mrms_deflate), instead of
+        running mkdir and gzip through system() for every file
+        - Output is gzip'd on the -threads pool, pigz-style, for
+        files over 128 KB
+        - Added -filter option: netCDF-4 output through HDF5 filter
+        plugins (zstd, LZ4, Blosc), chosen per product name pattern
+        - Idle pooled buffers are capped at a few levels of the
+        largest grid converted
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+
+/************************************************/
+/***  F U N C T I O N  P R O T O T Y P E (S)  ***/
+/************************************************/
+
+vector<ProductInfo> setupMRMS_ProductRefData( );
+                   
+string stripSpaces(string in);
+
+int productKnown(const char *varname, const char *varunit,
+                 vector<ProductInfo>& pInfo);
+
+int listInputFiles(const string &input_path, vector<string> &input_files);
+
+bool readAhead(const string &input_file);
+
+int makeOutputDir(const string &dir);
+
+void limitIdleBuffers(MrmsBufferPool &pool, size_t level_cells);
+
+int convertFile(const string &input_file, const string &output_path,
+                const ConverterOptions &options,
+                vector<ProductInfo>& productInfo,
+                MrmsByteOrderCache &byte_orders,
+                const void *input_buf = 0, size_t input_bytes = 0);
+
+int convertArchive(const string &archive_file, const string &output_path,
+                   const ConverterOptions &options,
+                   vector<ProductInfo>& productInfo,
+                   MrmsByteOrderCache &byte_orders,
+                   int &num_files, int &num_failed, int &num_skipped);
+
+//also see func_prototype.h
+
+
+
+/********************************/
+/***  M A I N  P R O G R A M  ***/
+/********************************/
+
+int main(int argc,  char* argv[])
+{
+    cout<<"\n\n"<<endl;
+    cout<<"      *************************************************"<<endl;
+    cout<<"      *                                               *"<<endl;
+    cout<<"      *       WELCOME TO MRMS->CFNCDF CONVERTER       *"<<endl;
+    cout<<"      *              v1.3.0 10/17/2026                *"<<endl;
+    cout<<"      *                                               *"<<endl;
+    cout<<"      *************************************************"<<endl;
+    cout<<endl;
+    
+
+
+    /*---------------------------------------*/
+    /*** 0. Process command-line arguments ***/ 
+    /*---------------------------------------*/
+
+    //Process command-line arguments
+    if( argc < 3 )
+    {
+      cout<<"Usage:  mrms_to_CFncdf [input file] [output path] (options)"<<endl;
+      cout<<"  [input file]: full path and filename of input file, or a "
+          <<"directory to convert every file in it.  Tar archives are "
+          <<"converted member by member"<<endl;
+      cout<<"  [output path]: top level output directory for netCDF"<<endl;
+      ConverterOptions::printUsage();
+
+      cout<<"Exiting from mrms_to_CFncdf"<<endl<<endl;
+      exit(0);
+    }
+    
+    string input_path = argv[1];
+    string output_path = argv[2];
+    
+    
+    ConverterOptions options;
+    if( options.parse(argc, argv, 3) < 0 )
+    {
+      cout<<"Exiting from mrms_to_CFncdf"<<endl<<endl;
+      exit(0);
+    }
+
+    options.print();
+    cout<<endl;
+
+    //data buffers are reused from file to file
+    MrmsBufferPool::shared().setHugePages(options.hugePages);
+
+    //workers for the unscale and flip, kept for the whole run
+    ThreadPool::shared().setThreads(options.numThreads);
+    
+    
+    
+    /*---------------------------------------*/
+    /*** 1. Read in product reference data ***/
+    /*---------------------------------------*/
+
+    vector<ProductInfo> productInfo;
+    productInfo = setupMRMS_ProductRefData( );
+    
+    if(productInfo.size() < 1)
+    {
+      cout<<"+++ERROR: Failed to setup product reference information from. Exiting!"
+          <<endl<<endl;
+      exit(0);
+    }
+    
+        
+
+    /*-------------------------------------*/
+    /*** 2. Convert input file(s)        ***/
+    /*-------------------------------------*/
+
+    //Files in the same directory usually share a byte order, so the
+    //order detected for one file is tried first for the next
+    MrmsByteOrderCache byte_orders;
+
+    vector<string> input_files;
+    if( listInputFiles(input_path, input_files) < 0 ) exit(0);
+
+    //The other (small, gzip'd) files of a directory are read ahead of
+    //the one being converted, a queue depth at a time.  The rest are
+    //read by name (see readAhead).
+    vector<bool> queued(input_files.size(), false);
+    vector<string> queue_files;
+
+    for(size_t f = 0; (input_files.size() > 1) && (options.queueDepth > 0) &&
+                      (f < input_files.size()); f++)
+    {
+      queued[f] = readAhead(input_files[f]);
+
+      if(queued[f]) queue_files.push_back(input_files[f]);
+    }
+
+    MrmsFileQueue queue;
+    if( !queue_files.empty() )
+    {
+      queue.open(queue_files, options.queueDepth);
+
+      if( !queue.asynchronous() )
+        cout<<"io_uring is not available; reading input files one at a "
+            <<"time"<<endl<<endl;
+    }
+
+    int num_files = 0, num_failed = 0, num_skipped = 0;
+    for(size_t f = 0; f < input_files.size(); f++)
+    {
+      if( MrmsTarReader::isArchiveName(input_files[f]) )
+      {
+        convertArchive(input_files[f], output_path, options, productInfo,
+                       byte_orders, num_files, num_failed, num_skipped);
+        continue;
+      }
+
+      num_files++;
+
+      int converted;
+
+      if( !queued[f] )
+      {
+        converted = convertFile(input_files[f], output_path, options,
+                                productInfo, byte_orders);
+      }
+      else if(queue.next() < 0)
+      {
+        cout<<"+++ERROR: "<<queue.errorMessage()<<" Skipping!"<<endl;
+        converted = -1;
+      }
+      else
+      {
+        converted = convertFile(queue.fileName(), output_path, options,
+                                productInfo, byte_orders,
+                                queue.data(), queue.size());
+      }
+
+      if(converted < 0) num_failed++;
+      else if(converted == 0) num_skipped++;
+    }
+
+    if(num_skipped > 0)
+      cout<<"Skipped "<<num_skipped<<" of "<<num_files
+          <<" file(s) not matching -field"<<endl;
+
+    if(num_failed > 0)
+      cout<<"+++ERROR: Failed to convert "<<num_failed<<" of "
+          <<num_files<<" file(s)"<<endl;
+
+    cout<<"CONVERTER DONE."<<endl<<endl;
+    return 1;
+    
+}//end main function
+
+
+
+
+/**************************/
+/*** F U N C T I O N S  ***/
+/**************************/
+
+//also see mrms_binary_reader.cc, write_CF_netCDF_2d.cc, write_CF_netCDF_2d_FAA.cc,
+// write_CF_netCDF_3d.cc, write_CF_netCDF_3d_FAA.cc
+
+/*------------------------------------------------------------------
+
+	Function:	convertFile
+
+	Purpose:	Read one MRMS binary file and write it as CF netCDF
+
+	Input:		input_file = path and name of the MRMS binary file
+	            output_path = top level output directory
+	            options = command-line options
+	            productInfo = product reference data
+	            byte_orders = byte order detected per directory
+	            input_buf, input_bytes = the file's bytes when they
+	               are already in memory (input_file is then only
+	               its name), or 0 to read input_file
+
+	Output:		int indicating success (1), a file skipped by
+	            -field (0) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int convertFile(const string &input_file, const string &output_path,
+                const ConverterOptions &options,
+                vector<ProductInfo>& productInfo,
+                MrmsByteOrderCache &byte_orders,
+                const void *input_buf, size_t input_bytes)
+{
+    /*----------------------------------------*/
+    /*** 1. Read input file and error check ***/
+    /*----------------------------------------*/
+    
+    //Declare some reusable variables
+    MrmsBufferPool &pool = MrmsBufferPool::shared();
+    MrmsSlabReader slabs;
+    slabs.setBufferPool(&pool);
+    MrmsGrid grid;
+    grid.setBufferPool(&pool);
+    grid.setInflateBackend(options.inflateBackend);
+    grid.setThreads(options.numThreads);
+    string varname;
+    string varunit;
+        
+    int pIndex = -1;
+    
+    
+    cout<<" Processing: "<<input_file<<endl;
+      
+      
+    /*** 1A. Read file header and data ***/
+
+    //3D data, and any data being cropped, is streamed a level at a
+    //time while writing (see 2B), so only the header is read here.
+    //Other 2D data is read whole.  Bytes already in memory (queued
+    //files, archive members) are read through a source, opened again
+    //to read them a second time.
+    MrmsSource source;
+
+    if( (input_buf != 0) &&
+        (source.open(input_buf, input_bytes, input_file.c_str()) < 0) )
+    {
+      cout<<"+++ERROR: Failed to read "<<input_file<<" Skipping!"<<endl;
+      return -1;
+    }
+
+    int open_status = source.isOpen() ?
+      slabs.open(source, options.swapFlag, &byte_orders) :
+      slabs.open(input_file.c_str(), options.swapFlag, &byte_orders);
+
+    if(open_status < 0)
+    {
+      cout<<"+++ERROR: "<<slabs.errorMessage()<<endl;
+      cout<<"+++ERROR: Failed to read "<<input_file<<" Skipping!"<<endl;
+      return -1;
+    }
+
+    //Files of other fields are passed over after the header
+    if( !options.fieldPattern.empty() &&
+        (fnmatch(options.fieldPattern.c_str(),
+                 stripSpaces(slabs.header().varName).c_str(), 0) != 0) )
+    {
+      cout<<" Skipping "<<input_file<<" ("<<slabs.header().varName
+          <<" does not match -field)"<<endl<<endl;
+      return 0;
+    }
+
+    if( options.cropGrid &&
+        (slabs.crop(options.cropSouth, options.cropNorth,
+                    options.cropWest, options.cropEast) < 0) )
+    {
+      cout<<"+++ERROR: "<<slabs.errorMessage()<<endl;
+      cout<<"+++ERROR: Failed to crop "<<input_file<<" Skipping!"<<endl;
+      return -1;
+    }
+
+    limitIdleBuffers(pool, (size_t)slabs.header().nx*slabs.header().ny);
+
+    bool read_whole = (slabs.header().nz == 1) && !options.cropGrid;
+
+    if(read_whole)
+    {
+      slabs.close();
+
+      int read_status = (input_buf != 0) ?
+        ( (source.open(input_buf, input_bytes, input_file.c_str()) < 0) ? -1 :
+          grid.read(source, slabs.header().swapFlag) ) :
+        grid.read(input_file.c_str(), slabs.header().swapFlag);
+
+      if(read_status < 0)
+      {
+        cout<<"+++ERROR: "<<grid.errorMessage()<<endl;
+        cout<<"+++ERROR: Failed to read "<<input_file<<" Skipping!"<<endl;
+        return -1;
+      }
+      if( !grid.warningMessage().empty() )
+        cout<<"+++WARNING: "<<grid.warningMessage()<<endl;
+    }
+     
+    cout<<" DONE reading file";
+    if(!read_whole) cout<<" header";
+    if(slabs.header().swapFlag) cout<<" (byte swapped)";
+    cout<<endl;
+
+    const MrmsHeader &hdr = slabs.header();
+    int var_scale = hdr.varScale, missing = hdr.missingVal;
+    float nw_lat = hdr.nwLat, nw_lon = hdr.nwLon;
+    int nx = hdr.nx, ny = hdr.ny, nz = hdr.nz;
+    float dx = hdr.dx, dy = hdr.dy;
+    vector<float> zhgt = hdr.zhgt;
+    time_t epoch_sec = hdr.epochSeconds;
+    struct tm valid_time;
+    gmtime_r(&epoch_sec, &valid_time);
+      
+      
+    /*** 1B. Check if entry for data field exists in product ref data ***/
+     
+    //Remove any spaces in variable name. Replace with underscore
+    varname = stripSpaces(hdr.varName);
+
+    //Remove any spaces in variable unit. Replace with underscore
+    //cout<<"VarUnit b4: >"<<hdr.varUnit<<"<"<<endl;
+    varunit = stripSpaces(hdr.varUnit);
+    //cout<<"VarUnit aft: >"<<varunit<<"<"<<endl;
+
+    //Find the data field in the product reference info
+    pIndex = productKnown(varname.c_str(), varunit.c_str(), productInfo);
+      
+    if(pIndex < 0)
+    {
+      cout<<"+++ERROR: Data field (name="<<varname<<", unit="<<varunit
+          <<") not found in product reference info"<<endl;
+      return -1;
+    }
+      
+      
+    /*** 1C. Helpful print statement ***/
+      
+    //Print out header info.
+    cout<<endl<<" Binary Header Info:"<<endl;
+    cout<<"  variable name = "<<varname<<endl;
+    cout<<"  variable unit = "<<varunit<<endl;
+    cout<<"  number of radars = "<<hdr.nradars<<endl;
+    
+    cout<<"  Radars: ";
+    for(size_t i = 0; i < hdr.radarNames.size(); i++)
+      cout<<hdr.radarNames[i]<<" ";
+    cout<<endl;
+    
+    cout<<"  variable scale = "<<var_scale<<endl;
+    cout<<"  missing value = "<<missing<<endl;
+    cout<<"  NW latitude = "<<nw_lat<<endl;
+    cout<<"  NW longitude = "<<nw_lon<<endl;
+    cout<<"  Number of columns = "<<nx<<endl;
+    cout<<"  Number of rows = "<<ny<<endl;
+    cout<<"  Number of levels = "<<nz<<endl;
+    cout<<"  Grid cell size (degree lat.) = "<<dy<<endl;
+    cout<<"  Grid cell size (degree lon.) = "<<dx<<endl;
+    cout<<"  Number of vertical levels = "<<nz<<endl;
+    
+    cout<<"  Level heights = ";
+    for(int i = 0; i < nz; i++) cout<<zhgt[i]<<" ";
+    cout<<endl;
+    
+    char timestamp[20];
+    strftime(timestamp, 20, "%m/%d/%Y %H%M", &valid_time);
+    cout<<"  Time = "<<timestamp<<" UTC  (or "<<epoch_sec
+        <<" epoch seconds)"<<endl<<endl;
+          
+    //How stored values become output values: unscaled, and for
+    //some products sentinels remapped and units converted through
+    //a lookup table built once per product
+    const ValueTable &values = ValueTable::forProduct(productInfo[pIndex],
+                                                      var_scale, missing);
+
+    if( !values.plain() )
+    {
+      cout<<"  Decoding through a lookup table";
+      if(values.unitFactor() != 1.0)
+        cout<<" ("<<productInfo[pIndex].varUnit<<" to "
+            <<productInfo[pIndex].cfUnit<<", x "<<values.unitFactor()<<")";
+      cout<<endl;
+    }
+      
+            
+      
+    /*------------------------*/
+    /*** 2. Write CF netCDF ***/
+    /*------------------------*/
+
+      
+    /*** 2A. Prep for file output (header) ***/
+    
+    //bookkeeping
+    int status = 0;
+    
+    //file and directory names
+    char output_path_fname[500];
+    char output_dir[500];
+    
+    vector<HeaderAttribute> attrs; //keep empty
+      
+    long fcstTime = (long)productInfo[pIndex].fcstTime;
+    string dataType = productInfo[pIndex].cfName;
+    string longName = productInfo[pIndex].cfLongName;
+    string varName = productInfo[pIndex].cfName;
+    string varUnit = productInfo[pIndex].cfUnit;
+    if(varUnit == "none") varUnit.clear();
+      
+    //Set time parameters for valid time. Take forecast products into account.
+    string cf_time_string;
+    long cf_fcst_length;
+    
+    if(fcstTime > 0)
+    {
+      //If product is a forecast
+      char tmp_cf_time_string[50];
+      strftime(tmp_cf_time_string, 50,
+             "seconds since %Y-%m-%d %H:%M:%S", &valid_time);
+      cf_time_string = tmp_cf_time_string;
+      cf_fcst_length = fcstTime;
+    }
+    else
+    {
+      //If product is NOT a forecast, then set time parameters 
+      //for valid time
+      cf_time_string = "seconds since 1970-1-1 0:0:0";
+      cf_fcst_length = epoch_sec;  
+    }
+
+      
+      
+    //Data time info
+    strftime (timestamp, 20, "%Y%m%d-%H%M%S", &valid_time);    
+    float fractional_time = 0.0; //milliseconds
+    
+    
+    //Check for special case where output path should include subdir
+    //based on height of field (e.g., mrefl_levels)
+    bool wrtSubDir = false;
+    char sub_dir[20];
+
+    if( (nz == 1) && 
+        ( (varName == "MREFL") || (varName == "MKDP") || (varName == "MRHOHV") || (varName == "MSPW") || (varName == "MZDR") ) )
+    {
+      cout<<"Looks like we're converting 2D slices of 3D reflectivity. "
+          <<"Writing output to height-based subdirectories."<<endl;
+      wrtSubDir = true;
+    
+      if(zhgt[0] < 1000)
+        sprintf(sub_dir, "0%.2f", (zhgt[0]/1000.0));
+      else if(zhgt[0] < 10000)
+        sprintf(sub_dir, "0%.2f", (zhgt[0]/1000.0));
+      else
+        sprintf(sub_dir, "%.2f", (zhgt[0]/1000.0));    
+    }
+          
+          
+    //Build output file name and
+    //make the output directory (if not made already)
+    // structure:  [top dir]/[product]
+    //  subproduct = height level
+    if(wrtSubDir)
+    {
+      sprintf(output_path_fname, "%s/%s/%s/%s.netcdf", output_path.c_str(),
+                           varName.c_str(), sub_dir, timestamp);
+      sprintf(output_dir, "%s/%s/%s", 
+             output_path.c_str(), varName.c_str(), sub_dir);
+    }
+    else
+    {
+      sprintf(output_path_fname, "%s/%s/%s.netcdf", output_path.c_str(),
+                           varName.c_str(), timestamp);
+      sprintf(output_dir, "%s/%s", 
+             output_path.c_str(), varName.c_str());    
+    }
+
+    if(makeOutputDir(output_dir) < 0)
+    {
+      cout<<"+++ERROR: Cannot make output directory "<<output_dir<<": "
+          <<strerror(errno)<<" Skipping!"<<endl;
+      return -1;
+    }
+          
+          
+      
+    //netCDF-4 files are compressed in place, classic ones gzip'd
+    int gzip_flag = options.netcdf4 ? 0 : 1;
+    float missing_value = values.missingValue();
+    float range_folded_value = missing_value -1;
+
+    //-packed: the stored values themselves, if unscaling is all
+    //that is done to them and the missing value packs exactly
+    OutputFormat format;
+    format.swOrigin = options.swOrigin;
+    format.netcdf4 = options.netcdf4;
+    format.deflateLevel = options.deflateLevel;
+    format.shuffle = options.shuffle;
+    format.chunkRows = options.chunkRows;
+    format.chunkCols = options.chunkCols;
+
+    const OutputFilter *filter = options.filterFor(varName);
+    if(filter != 0) format.filter = *filter;
+
+    if(options.packed)
+    {
+      double packed_missing = (double)missing_value * var_scale;
+
+      if( values.plain() && (var_scale > 0) && (fabs(packed_missing) <= 32767) &&
+          ( (float)(lround(packed_missing) / (double)var_scale) == missing_value ) )
+        format.packScale = var_scale;
+      else
+        cout<<"  Values cannot be written as stored: writing floats, not -packed"<<endl;
+    }
+      
+    
+      
+    /*** 2B. Prep for file output (data) ***/
+
+    //unscale and flip orgin to be NW (instead of SW) corner, unless
+    //-sworigin.  The writer pulls each level through the slab reader
+    //(or from the grid, if read whole) into one level-sized buffer,
+    //or for -packed takes the stored level as it is
+    MrmsLevelSource levels(slabs, read_whole ? &grid : 0);
+    levels.setFlip( !options.swOrigin );
+    levels.setSimd(options.simdIsa);
+    levels.setThreadPool(&ThreadPool::shared());
+    levels.setValueTable(&values);
+      
+
+      
+    /*** 2C. Determine if 2D or 3D data.  Call correct output function ***/
+    if(nz > 1)
+    {
+      if( options.faaCompliant )
+      {
+        cout<<" Writing 3D file (compliant with FAA display requirements)."<<endl;
+        status = write_CF_netCDF_3d_FAA( (string)output_path_fname, 
+                     dataType, longName, varName, varUnit,  
+                     nx, ny, nz, dx, dy, nw_lat, nw_lon, &zhgt[0],
+                     epoch_sec, fractional_time,
+                     missing_value, range_folded_value,
+                     levels, gzip_flag, format);
+      }
+      else
+      {
+        cout<<" Writing 3D file."<<endl;
+        status = write_CF_netCDF_3d( (string)output_path_fname, 
+                     dataType, longName, varName, varUnit,  
+                     nx, ny, nz, dx, dy, nw_lat, nw_lon, &zhgt[0],
+                     epoch_sec, fractional_time,
+                     missing_value, range_folded_value,
+                     levels, gzip_flag, format);
+      }
+      
+    }
+    else
+    {
+      if( options.faaCompliant )
+      {
+        cout<<" Writing 2D file (compliant with FAA display requirements)."<<endl;
+        status = write_CF_netCDF_2d_FAA( (string)output_path_fname, 
+                     dataType, longName, varName, varUnit,  
+                     nx, ny, dx, dy, nw_lat, nw_lon, zhgt[0],
+                     epoch_sec, fractional_time, cf_time_string, 
+                     cf_fcst_length, attrs, missing_value, range_folded_value,
+                     levels, gzip_flag, format);
+               
+      }
+      else
+      {
+        cout<<" Writing 2D file."<<endl;
+        status = write_CF_netCDF_2d( (string)output_path_fname, 
+                     dataType, longName, varName, varUnit,  
+                     nx, ny, dx, dy, nw_lat, nw_lon, zhgt[0],
+                     epoch_sec, fractional_time, cf_time_string, 
+                     cf_fcst_length, attrs, missing_value, range_folded_value,
+                     levels, gzip_flag, format);
+               
+      }
+        
+    }//end if-blk (nz > 1)
+      
+      
+    if(status > 0)
+    {
+      cout<<" Output is "<<output_path_fname;
+      if(gzip_flag) cout<<".gz"<<endl;
+      else cout<<endl;
+    }
+      
+    cout<<" DONE writing"<<endl<<endl;
+          
+
+    
+    /*------------------------*/
+    /*** 3. Free-up Memory, ***/
+    /*------------------------*/
+
+    //memory clean-up (slab reader frees its own data)
+    grid.clear();
+                
+    if(status > 0) return 1;
+    return -1;
+
+}//end function convertFile
+
+
+
+/*------------------------------------------------------------------
+
+	Function:	convertArchive
+
+	Purpose:	Convert each member of a tar archive (that matches
+	            -member), reading the archive once from start to
+	            end.  Nothing is extracted to disk.
+
+	Input:		archive_file = path and name of the tar archive
+	            output_path, options, productInfo, byte_orders =
+	               as for convertFile
+	            num_files, num_failed, num_skipped = running counts
+	               of files tried, failed and skipped by -field
+
+	Output:		int indicating the whole archive was read (1) or
+	            not (-1)
+
+------------------------------------------------------------------*/
+
+int convertArchive(const string &archive_file, const string &output_path,
+                   const ConverterOptions &options,
+                   vector<ProductInfo>& productInfo,
+                   MrmsByteOrderCache &byte_orders,
+                   int &num_files, int &num_failed, int &num_skipped)
+{
+    MrmsTarReader archive;
+    archive.setPattern(options.memberPattern);
+
+    cout<<" Reading archive: "<<archive_file<<endl<<endl;
+
+    if(archive.open(archive_file.c_str()) < 0)
+    {
+      cout<<"+++ERROR: "<<archive.errorMessage()<<" Skipping!"<<endl;
+      num_files++;
+      num_failed++;
+      return -1;
+    }
+
+    int status;
+    while( (status = archive.next()) > 0 )
+    {
+      num_files++;
+
+      string member_file = archive_file + "/" + archive.memberName();
+      MrmsSource *member = archive.member();
+
+      if(member == 0)
+      {
+        cout<<"+++ERROR: "<<archive.errorMessage()<<endl;
+        num_failed++;
+        continue;
+      }
+
+      int converted = convertFile(member_file, output_path, options,
+                                  productInfo, byte_orders,
+                                  member->memory(), member->memoryBytes());
+
+      if(converted < 0) num_failed++;
+      else if(converted == 0) num_skipped++;
+    }
+
+    if(archive.numSkipped() > 0)
+      cout<<" Passed over "<<archive.numSkipped()<<" archive member(s) "
+          <<"(directories, links, or not matching -member)"<<endl<<endl;
+
+    if(status < 0)
+    {
+      cout<<"+++ERROR: "<<archive.errorMessage()<<endl;
+      cout<<"+++ERROR: Stopped reading "<<archive_file<<endl;
+      num_failed++;
+      return -1;
+    }
+
+    return 1;
+
+}//end function convertArchive
+
+
+
+/*------------------------------------------------------------------
+
+	Function:	listInputFiles
+
+	Purpose:	Build the list of files to convert.  A file is
+	            converted on its own.  For a directory, every
+	            regular file in it is converted, in name order.
+
+	Output:		int indicating success (1) or failure (-1)
+
+------------------------------------------------------------------*/
+
+int listInputFiles(const string &input_path, vector<string> &input_files)
+{
+    input_files.clear();
+
+    DIR *dir = opendir(input_path.c_str());
+    if(dir == 0)
+    {
+      input_files.push_back(input_path);
+      return 1;
+    }
+
+    struct dirent *entry;
+    struct stat st;
+
+    while( (entry = readdir(dir)) != 0 )
+    {
+      string fname = input_path + "/" + entry->d_name;
+
+      if( (stat(fname.c_str(), &st) == 0) && S_ISREG(st.st_mode) )
+        input_files.push_back(fname);
+    }
+
+    closedir(dir);
+
+    if(input_files.empty())
+    {
+      cout<<"+++ERROR: No files found in "<<input_path<<endl;
+      return -1;
+    }
+
+    sort(input_files.begin(), input_files.end());
+
+    return 1;
+
+}//end function listInputFiles
+
+
+
+/*------------------------------------------------------------------
+
+	Function:	readAhead
+
+	Purpose:	Decide whether a file of a directory goes through
+	            the read-ahead queue, which reads it whole into
+	            memory.  Only gzip'd files (by name) of up to
+	            MAX_QUEUED_BYTES are queued, so queued memory
+	            stays under the queue depth times that.  Plain
+	            files are mapped and big ones streamed a level at
+	            a time when read by name; archives are read on
+	            their own, and files with a random-access index
+	            by name so they can be inflated on several
+	            threads.
+
+	Output:		bool, true to queue the file
+
+------------------------------------------------------------------*/
+
+bool readAhead(const string &input_file)
+{
+    static const size_t MAX_QUEUED_BYTES = (size_t)16 << 20;
+
+    size_t len = input_file.size();
+    if( (len < 3) || (input_file.compare(len-3, 3, ".gz") != 0) ) return false;
+
+    if( MrmsTarReader::isArchiveName(input_file) ) return false;
+
+    struct stat st;
+    if( (stat(input_file.c_str(), &st) != 0) ||
+        ((size_t)st.st_size > MAX_QUEUED_BYTES) ) return false;
+
+    return (stat(MrmsGzIndex::sidecarName(input_file.c_str()).c_str(), &st) != 0);
+
+}//end function readAhead
+
+
+
+/*------------------------------------------------------------------
+
+	Function:	makeOutputDir
+
+	Purpose:	Make directory dir and any missing parents, like
+	            "mkdir -p" but in process.  Directories made (or
+	            found) are remembered for the rest of the run, so
+	            each file of a product after the first costs a
+	            lookup only.
+
+	Output:		int indicating success (1) or failure (-1, with
+	            errno set)
+
+------------------------------------------------------------------*/
+
+int makeOutputDir(const string &dir)
+{
+    static mutex guard;
+    static set<string> made;
+
+    lock_guard< mutex > lock(guard);
+
+    if(made.count(dir) > 0) return 1;
+
+    //each parent in turn, then dir itself
+    for(size_t slash = dir.find('/', 1); ; slash = dir.find('/', slash+1))
+    {
+      string part = dir.substr(0, slash);
+
+      if( !part.empty() && (mkdir(part.c_str(), 0777) < 0) && (errno != EEXIST) )
+        return -1;
+
+      if(slash == string::npos) break;
+    }
+
+    struct stat st;
+    if( (stat(dir.c_str(), &st) < 0) ) return -1;
+    if( !S_ISDIR(st.st_mode) )
+    {
+      errno = ENOTDIR;
+      return -1;
+    }
+
+    made.insert(dir);
+
+    return 1;
+
+}//end function makeOutputDir
+
+
+
+/*------------------------------------------------------------------
+
+	Function:	limitIdleBuffers
+
+	Purpose:	Bound the bytes the buffer pool keeps idle between
+	            files to IDLE_LEVELS float levels of the largest
+	            grid converted so far.  Every pooled buffer (data
+	            array of a 2D grid, slab of a 3D one) is at most a
+	            level of int16, so the buffers of the largest
+	            product are still reused, but buffers of a grid
+	            seen once no longer pile up for the rest of a run.
+
+	Input:		pool = the buffer pool
+	            level_cells = cells in one level of this file
+
+------------------------------------------------------------------*/
+
+void limitIdleBuffers(MrmsBufferPool &pool, size_t level_cells)
+{
+    static const size_t IDLE_LEVELS = 4;
+    static mutex guard;
+    static size_t max_cells = 0;
+
+    lock_guard< mutex > lock(guard);
+
+    if(level_cells <= max_cells) return;
+
+    max_cells = level_cells;
+    pool.setMaxIdleBytes(IDLE_LEVELS*max_cells*sizeof(float));
+
+}//end function limitIdleBuffers
+
+
+
+string stripSpaces(string in)
+{
+    string out = in;
+    size_t length;
+  
+    while(out.find(" ") != string::npos)
+    {
+      length = out.length();
+      
+      if( (out.find(" ") == 0) && (length > 1) )
+      {
+        out = out.substr(1);
+      }
+      else if( (out.find(" ") == (length-1)) && 
+               (length > 1) )
+      {
+        out = out.substr(0, (length-1));
+      }
+      else if(length <= 1)
+      {
+        out.clear();
+      }
+      else
+      {  
+        out[out.find(" ")] = '_';
+      }
+       
+    }//end while-loop
+    
+    //the loop above may result in extra leading or ending underscores.
+    //e.g., when there are more than one leading or ending spaces
+    //undo the damage here. 
+    while(out.find("_") != string::npos)
+    {      
+      if(out.rfind("_") == 0)
+        out = out.substr(1);  
+      else break;      
+    }
+
+    while(out.rfind("_") != string::npos)
+    {
+      length = out.length();
+      
+      if(out.rfind("_") == (length-1))
+        out = out.substr(0, (length-1));
+      else break;
+    }
+           
+    return out;
+  
+}//end function stripSpaces
+
+
+
+int productKnown(const char *varname, const char *varunit, 
+                 vector<ProductInfo>& pInfo)
+{
+    string pName = varname;
+    string pUnit = varunit;
+    
+    if(pName.empty()) return -1;
+    //if(pUnit.empty()) return -1;
+    
+    
+    for(size_t p = 0; p < pInfo.size(); p++)
+    {
+      if( pInfo[p].isMatch( pName, pUnit ) )  return p;
+      
+    }//end p-loop
+    
+    return -1;
+
+}//end functio productKnown
+                 
@@ -0,0 +1,547 @@
+#include <string.h>
+#include <stdint.h>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MRMS_HAVE_X86_SIMD
+#endif
+
+#include "mrms_unscale.h"
+
+using namespace std;
+
+
+// C O N S T A N T S
+
+//how a scale is applied (MrmsUnscale::method)
+enum { METHOD_DIVIDE = 0, METHOD_MULTIPLY = 1, METHOD_CORRECT = 2,
+       METHOD_TABLE = 3 };
+
+//Output at least this big is written with streaming stores: it
+//would not stay in cache anyway, and it is not read first
+static const size_t STREAM_BYTES = (size_t)16 << 20;
+
+
+
+// F U N C T I O N S
+
+/*------------------------------------------------------------------
+
+	Function:	unscale_value
+
+	Purpose:	One value, the way the row kernels do it
+
+------------------------------------------------------------------*/
+
+static inline float unscale_value(int method, float scale, float recip,
+                                  short int value)
+{
+    float x = (float)value;
+
+    if(method == METHOD_MULTIPLY) return x * recip;
+
+    if(method == METHOD_CORRECT)
+    {
+      float q = x * recip;
+      return fmaf(fmaf(-q, scale, x), recip, q);
+    }
+
+    return x / scale;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	unscale_scalar
+
+	Purpose:	Unscale values first..num_values-1 one at a time
+	            (any CPU, and the ends of vector rows)
+
+------------------------------------------------------------------*/
+
+static void unscale_scalar(const MrmsUnscale &unscale, const short int *in,
+                           float *out, size_t first, size_t num_values)
+{
+    for(size_t i = first; i < num_values; i++)
+      out[i] = unscale_value(unscale.method, unscale.scale, unscale.recip, in[i]);
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	lookup_scalar
+
+	Purpose:	Decode values first..num_values-1 through the table
+	            one at a time
+
+------------------------------------------------------------------*/
+
+static void lookup_scalar(const float *table, const short int *in,
+                          float *out, size_t first, size_t num_values)
+{
+    const unsigned short *index = reinterpret_cast< const unsigned short * >( in );
+
+    for(size_t i = first; i < num_values; i++)
+      out[i] = table[ index[i] ];
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	exact_method
+
+	Purpose:	True if method gives (float)x / scale, bit for bit,
+	            for every short int x
+
+------------------------------------------------------------------*/
+
+static bool exact_method(int method, float scale, float recip)
+{
+    for(int x = -32768; x <= 32767; x++)
+    {
+      float expect = (float)x / scale;
+      float got = unscale_value(method, scale, recip, (short int)x);
+
+      uint32_t expect_bits, got_bits;
+      memcpy(&expect_bits, &expect, 4);
+      memcpy(&got_bits, &got, 4);
+
+      if(expect_bits != got_bits) return false;
+    }
+
+    return true;
+}
+
+
+
+#ifdef MRMS_HAVE_X86_SIMD
+
+/*------------------------------------------------------------------
+
+	Function:	unscale_sse2
+
+	Purpose:	Unscale 8 values at a time (SSE2 has no 16- to
+	            32-bit sign extension: unpack and shift instead).
+	            SSE2 has no FMA, so METHOD_CORRECT is never used.
+
+------------------------------------------------------------------*/
+
+__attribute__((target("sse2")))
+static void unscale_sse2(const MrmsUnscale &unscale, const short int *in,
+                         float *out, size_t num_values)
+{
+    __m128 scale = _mm_set1_ps(unscale.scale);
+    __m128 recip = _mm_set1_ps(unscale.recip);
+    bool multiply = (unscale.method == METHOD_MULTIPLY);
+
+    //streaming stores need aligned output
+    size_t i = 0;
+    if(unscale.stream)
+    {
+      for( ; (i < num_values) && ((uintptr_t)(out + i) & 15); i++)
+        out[i] = unscale_value(unscale.method, unscale.scale, unscale.recip, in[i]);
+    }
+
+    for( ; i + 8 <= num_values; i += 8)
+    {
+      __m128i v = _mm_loadu_si128( (const __m128i *)(in + i) );
+      __m128 lo = _mm_cvtepi32_ps( _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16) );
+      __m128 hi = _mm_cvtepi32_ps( _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16) );
+
+      if(multiply)
+      {
+        lo = _mm_mul_ps(lo, recip);
+        hi = _mm_mul_ps(hi, recip);
+      }
+      else
+      {
+        lo = _mm_div_ps(lo, scale);
+        hi = _mm_div_ps(hi, scale);
+      }
+
+      if(unscale.stream)
+      {
+        _mm_stream_ps(out + i, lo);
+        _mm_stream_ps(out + i + 4, hi);
+      }
+      else
+      {
+        _mm_storeu_ps(out + i, lo);
+        _mm_storeu_ps(out + i + 4, hi);
+      }
+    }
+
+    if(unscale.stream) _mm_sfence();
+
+    unscale_scalar(unscale, in, out, i, num_values);
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	unscale_avx2
+
+	Purpose:	Unscale 16 values at a time
+
+------------------------------------------------------------------*/
+
+__attribute__((target("avx2,fma")))
+static inline __m256 apply_avx2(int method, __m256 x, __m256 scale,
+                                __m256 recip)
+{
+    if(method == METHOD_MULTIPLY) return _mm256_mul_ps(x, recip);
+
+    if(method == METHOD_CORRECT)
+    {
+      __m256 q = _mm256_mul_ps(x, recip);
+      return _mm256_fmadd_ps(_mm256_fnmadd_ps(q, scale, x), recip, q);
+    }
+
+    return _mm256_div_ps(x, scale);
+}
+
+
+__attribute__((target("avx2,fma")))
+static void unscale_avx2(const MrmsUnscale &unscale, const short int *in,
+                         float *out, size_t num_values)
+{
+    __m256 scale = _mm256_set1_ps(unscale.scale);
+    __m256 recip = _mm256_set1_ps(unscale.recip);
+    int method = unscale.method;
+
+    size_t i = 0;
+    if(unscale.stream)
+    {
+      for( ; (i < num_values) && ((uintptr_t)(out + i) & 31); i++)
+        out[i] = unscale_value(method, unscale.scale, unscale.recip, in[i]);
+
+      for( ; i + 8 <= num_values; i += 8)
+      {
+        __m128i v = _mm_loadu_si128( (const __m128i *)(in + i) );
+        __m256 x = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32(v) );
+
+        _mm256_stream_ps(out + i, apply_avx2(method, x, scale, recip));
+      }
+
+      _mm_sfence();
+    }
+
+    for( ; i + 16 <= num_values; i += 16)
+    {
+      __m128i v0 = _mm_loadu_si128( (const __m128i *)(in + i) );
+      __m128i v1 = _mm_loadu_si128( (const __m128i *)(in + i + 8) );
+      __m256 x0 = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32(v0) );
+      __m256 x1 = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32(v1) );
+
+      _mm256_storeu_ps(out + i, apply_avx2(method, x0, scale, recip));
+      _mm256_storeu_ps(out + i + 8, apply_avx2(method, x1, scale, recip));
+    }
+
+    unscale_scalar(unscale, in, out, i, num_values);
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	unscale_avx512
+
+	Purpose:	Unscale 32 values at a time
+
+------------------------------------------------------------------*/
+
+__attribute__((target("avx512f")))
+static inline __m512 apply_avx512(int method, __m512 x, __m512 scale,
+                                  __m512 recip)
+{
+    if(method == METHOD_MULTIPLY) return _mm512_mul_ps(x, recip);
+
+    if(method == METHOD_CORRECT)
+    {
+      __m512 q = _mm512_mul_ps(x, recip);
+      return _mm512_fmadd_ps(_mm512_fnmadd_ps(q, scale, x), recip, q);
+    }
+
+    return _mm512_div_ps(x, scale);
+}
+
+
+__attribute__((target("avx512f")))
+static void unscale_avx512(const MrmsUnscale &unscale, const short int *in,
+                           float *out, size_t num_values)
+{
+    __m512 scale = _mm512_set1_ps(unscale.scale);
+    __m512 recip = _mm512_set1_ps(unscale.recip);
+    int method = unscale.method;
+    const __mmask16 ALL16 = 0xffff;
+
+    //(maskz conversions: the plain ones trip -Wmaybe-uninitialized
+    //in GCC's headers)
+    size_t i = 0;
+    if(unscale.stream)
+    {
+      for( ; (i < num_values) && ((uintptr_t)(out + i) & 63); i++)
+        out[i] = unscale_value(method, unscale.scale, unscale.recip, in[i]);
+
+      for( ; i + 16 <= num_values; i += 16)
+      {
+        __m256i v = _mm256_loadu_si256( (const __m256i *)(in + i) );
+        __m512 x = _mm512_maskz_cvtepi32_ps( ALL16, _mm512_maskz_cvtepi16_epi32(ALL16, v) );
+
+        _mm512_stream_ps(out + i, apply_avx512(method, x, scale, recip));
+      }
+
+      _mm_sfence();
+    }
+
+    for( ; i + 32 <= num_values; i += 32)
+    {
+      __m256i v0 = _mm256_loadu_si256( (const __m256i *)(in + i) );
+      __m256i v1 = _mm256_loadu_si256( (const __m256i *)(in + i + 16) );
+      __m512 x0 = _mm512_maskz_cvtepi32_ps( ALL16, _mm512_maskz_cvtepi16_epi32(ALL16, v0) );
+      __m512 x1 = _mm512_maskz_cvtepi32_ps( ALL16, _mm512_maskz_cvtepi16_epi32(ALL16, v1) );
+
+      _mm512_storeu_ps(out + i, apply_avx512(method, x0, scale, recip));
+      _mm512_storeu_ps(out + i + 16, apply_avx512(method, x1, scale, recip));
+    }
+
+    unscale_scalar(unscale, in, out, i, num_values);
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	lookup_avx2
+
+	Purpose:	Decode 16 values at a time through the table with
+	            gathers.  Also used with AVX-512: its 16-wide
+	            gather was no faster (the table is 256 KB, so each
+	            gather waits on L2 either way).
+
+------------------------------------------------------------------*/
+
+__attribute__((target("avx2")))
+static void lookup_avx2(const MrmsUnscale &unscale, const short int *in,
+                        float *out, size_t num_values)
+{
+    const float *table = unscale.table;
+
+    size_t i = 0;
+    if(unscale.stream)
+    {
+      for( ; (i < num_values) && ((uintptr_t)(out + i) & 31); i++)
+        out[i] = table[ (unsigned short)in[i] ];
+
+      for( ; i + 8 <= num_values; i += 8)
+      {
+        __m128i v = _mm_loadu_si128( (const __m128i *)(in + i) );
+
+        _mm256_stream_ps(out + i, _mm256_i32gather_ps(table, _mm256_cvtepu16_epi32(v), 4));
+      }
+
+      _mm_sfence();
+    }
+
+    for( ; i + 16 <= num_values; i += 16)
+    {
+      __m128i v0 = _mm_loadu_si128( (const __m128i *)(in + i) );
+      __m128i v1 = _mm_loadu_si128( (const __m128i *)(in + i + 8) );
+
+      _mm256_storeu_ps(out + i, _mm256_i32gather_ps(table, _mm256_cvtepu16_epi32(v0), 4));
+      _mm256_storeu_ps(out + i + 8, _mm256_i32gather_ps(table, _mm256_cvtepu16_epi32(v1), 4));
+    }
+
+    lookup_scalar(table, in, out, i, num_values);
+}
+
+#endif
+
+
+/*------------------------------------------------------------------
+
+	Function:	detect_simd
+
+	Purpose:	Widest instruction set the CPU and OS support
+
+------------------------------------------------------------------*/
+
+static int detect_simd()
+{
+#ifdef MRMS_HAVE_X86_SIMD
+    __builtin_cpu_init();
+
+    if( __builtin_cpu_supports("avx512f") ) return MRMS_SIMD_AVX512;
+
+    if( __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") )
+      return MRMS_SIMD_AVX2;
+
+    if( __builtin_cpu_supports("sse2") ) return MRMS_SIMD_SSE2;
+#endif
+
+    return MRMS_SIMD_SCALAR;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	mrms_simd_default
+
+	Purpose:	Widest instruction set this CPU (and build)
+	            supports
+
+------------------------------------------------------------------*/
+
+int mrms_simd_default()
+{
+    static const int best = detect_simd();
+
+    return best;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	mrms_simd_available
+
+	Purpose:	True if the instruction set can be used here
+
+------------------------------------------------------------------*/
+
+bool mrms_simd_available(int isa)
+{
+    return (isa >= MRMS_SIMD_SCALAR) && (isa <= mrms_simd_default());
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	mrms_simd_name, mrms_simd_isa
+
+	Purpose:	Convert between an instruction set and its name
+
+------------------------------------------------------------------*/
+
+const char* mrms_simd_name(int isa)
+{
+    if(isa == MRMS_SIMD_SSE2) return "sse2";
+    if(isa == MRMS_SIMD_AVX2) return "avx2";
+    if(isa == MRMS_SIMD_AVX512) return "avx512";
+
+    return "scalar";
+}
+
+
+int mrms_simd_isa(const char *name)
+{
+    if(strcmp(name, "scalar") == 0) return MRMS_SIMD_SCALAR;
+    if(strcmp(name, "sse2") == 0) return MRMS_SIMD_SSE2;
+    if(strcmp(name, "avx2") == 0) return MRMS_SIMD_AVX2;
+    if(strcmp(name, "avx512") == 0) return MRMS_SIMD_AVX512;
+
+    return -1;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	mrms_unscale_setup
+
+	Purpose:	Choose how to apply var_scale: the fastest method
+	            that matches division for every input.  The check
+	            runs once per scale and thread (the last scale is
+	            remembered).  num_values (the values about to be
+	            unscaled) decides whether stores bypass the cache.
+
+------------------------------------------------------------------*/
+
+void mrms_unscale_setup(MrmsUnscale &unscale, int var_scale, int isa,
+                        size_t num_values, const float *table)
+{
+    thread_local int last_scale = 0, last_isa = -1, last_method = 0;
+
+    if( !mrms_simd_available(isa) ) isa = mrms_simd_default();
+
+    unscale.isa = isa;
+    unscale.scale = (float)var_scale;
+    unscale.recip = 1.0f / unscale.scale;
+    unscale.table = table;
+    unscale.stream = (isa > MRMS_SIMD_SCALAR) &&
+                     (num_values*sizeof(float) >= STREAM_BYTES);
+
+    if(table != 0)
+    {
+      unscale.method = METHOD_TABLE;
+      return;
+    }
+
+    if( (var_scale == last_scale) && (isa == last_isa) )
+    {
+      unscale.method = last_method;
+      return;
+    }
+
+    //only the FMA kernels apply the correction at speed
+    bool fma = (isa >= MRMS_SIMD_AVX2);
+
+    if( exact_method(METHOD_MULTIPLY, unscale.scale, unscale.recip) )
+      unscale.method = METHOD_MULTIPLY;
+    else if( fma && exact_method(METHOD_CORRECT, unscale.scale, unscale.recip) )
+      unscale.method = METHOD_CORRECT;
+    else
+      unscale.method = METHOD_DIVIDE;
+
+    last_scale = var_scale;
+    last_isa = isa;
+    last_method = unscale.method;
+}
+
+
+/*------------------------------------------------------------------
+
+	Function:	mrms_unscale_row
+
+	Purpose:	out[i] = (float)in[i] / var_scale, for i < num_values,
+	            with the kernel chosen by mrms_unscale_setup (or
+	            out[i] = table[(unsigned short)in[i]])
+
+------------------------------------------------------------------*/
+
+void mrms_unscale_row(const MrmsUnscale &unscale, const short int *in,
+                      float *out, size_t num_values)
+{
+    if(unscale.method == METHOD_TABLE)
+    {
+#ifdef MRMS_HAVE_X86_SIMD
+      if(unscale.isa >= MRMS_SIMD_AVX2)
+      {
+        lookup_avx2(unscale, in, out, num_values);
+        return;
+      }
+#endif
+
+      lookup_scalar(unscale.table, in, out, 0, num_values);
+      return;
+    }
+
+#ifdef MRMS_HAVE_X86_SIMD
+    if(unscale.isa == MRMS_SIMD_AVX512)
+    {
+      unscale_avx512(unscale, in, out, num_values);
+      return;
+    }
+
+    if(unscale.isa == MRMS_SIMD_AVX2)
+    {
+      unscale_avx2(unscale, in, out, num_values);
+      return;
+    }
+
+    if(unscale.isa == MRMS_SIMD_SSE2)
+    {
+      unscale_sse2(unscale, in, out, num_values);
+      return;
+    }
+#endif
+
+    unscale_scalar(unscale, in, out, 0, num_values);
+}
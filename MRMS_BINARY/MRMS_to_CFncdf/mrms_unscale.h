@@ -0,0 +1,91 @@
+#ifndef MRMS_UNSCALE_H
+#define MRMS_UNSCALE_H
+
+#include <cstddef>
+
+/*%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+	File:		mrms_unscale
+
+	Date:		October 2026
+
+	Author:		CIMMS/NSSL
+
+	Purpose:	Vector kernels that unscale rows of MRMS data
+	            (short int / var_scale to float), for x86-64 SSE2,
+	            AVX2 and AVX-512.  The best set the CPU has is
+	            picked at run time; the scalar loop is used
+	            anywhere else.
+
+	            Output is bit-identical to (float)x / (float)scale
+	            for every input.  Each scale is checked once over
+	            all 65536 short int values:
+	             - if x * (1/scale) always matches (powers of 2),
+	               rows are multiplied by the reciprocal
+	             - else, with FMA (AVX2/AVX-512), the product is
+	               corrected by its remainder, q + (x - q*scale) *
+	               (1/scale), if that always matches
+	             - else rows are divided, a vector at a time
+	            Levels too big to stay in cache are written with
+	            streaming (non-temporal) stores.
+
+	            A transform that is more than the scale (sentinels
+	            remapped, units converted; see ValueTable) is given
+	            as a table of the 65536 possible outputs, and rows
+	            are decoded by lookup (AVX2 gathers where there are
+	            any).  Lookup is slower than the arithmetic above,
+	            so plain unscaling never goes through a table.
+
+	_____________________________________________________________
+	Modification History:
+
+
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%*/
+
+
+// C O N S T A N T S
+
+static const int MRMS_SIMD_SCALAR = 0;
+static const int MRMS_SIMD_SSE2 = 1;
+static const int MRMS_SIMD_AVX2 = 2;
+static const int MRMS_SIMD_AVX512 = 3;
+
+
+// T Y P E S
+
+//How one scale is applied (see mrms_unscale_setup)
+struct MrmsUnscale
+{
+    int isa;
+    int method;
+    float scale;
+    float recip;
+    const float *table;      //output by (unsigned short)input, or 0
+    bool stream;
+};
+
+
+// F U N C T I O N  P R O T O T Y P E S
+
+//widest instruction set this CPU (and build) supports
+int mrms_simd_default();
+
+//true if the instruction set can be used here
+bool mrms_simd_available(int isa);
+
+//name of an instruction set ("scalar", "sse2", "avx2", "avx512"),
+//and the reverse (-1 if the name is unknown)
+const char* mrms_simd_name(int isa);
+int mrms_simd_isa(const char *name);
+
+//choose how to apply var_scale (or table, if not 0) with isa, for
+//a level of num_values
+void mrms_unscale_setup(MrmsUnscale &unscale, int var_scale, int isa,
+                        size_t num_values, const float *table = 0);
+
+//out[i] = (float)in[i] / var_scale (or table[(unsigned short)in[i]]),
+//for i < num_values
+void mrms_unscale_row(const MrmsUnscale &unscale, const short int *in,
+                      float *out, size_t num_values);
+
+#endif
@@ -8,6 +8,7 @@
 
 #include "HeaderAttribute.h"
 #include "func_prototype.h"
+#include "mrms_deflate.h"
 
 using namespace std;
 
@@ -48,8 +49,11 @@ using namespace std;
 				        optional global attributes.  Can be empty.
 				missing_value = missing data flag
 				range_folded_value = range folded data flag
-				data_1D = 2D data field stored as a row-major 1D array
+				levels = supplies the data field (its one level, a
+				         row-major 2D field)
 				gzip_flag = set to 1 and function will gzip output.
+				format = row order, whether values are packed, and
+				         file format (see OutputFormat.h)
 	                               
 	Output:		2D single variable CF-compliant netCDF
 				int indicating success or failure
@@ -64,19 +68,18 @@ int write_CF_netCDF_2d( string outputfile, string dataType,
                    string cf_time_string, long cf_fcst_length,
                    vector<HeaderAttribute>& attrs, 
                    float missing_value, float range_folded_value,
-                   float* data_1D, int gzip_flag)
+                   LevelSource &levels, int gzip_flag,
+                   const OutputFormat &format)
 {
     /*-----------------------------*/
     /*** 0. Handle trivial cases ***/
     /*-----------------------------*/
 
-    //No data field
-    if(data_1D == 0) return 0;
-    
-
     //Try to create and open the NetCDF outpu file 
     int file_handle;
-    int stat = nc_create(outputfile.c_str(), NC_CLOBBER, &file_handle);
+    size_t var_bytes = (size_t)nx * (size_t)ny * format.valueBytes();
+    int stat = nc_create(outputfile.c_str(),
+                         create_mode(var_bytes, NC_CLOBBER, format), &file_handle);
     check_err(stat,__LINE__,__FILE__); //exit if fail
 
 
@@ -127,10 +130,10 @@ int write_CF_netCDF_2d( string outputfile, string dataType,
       lon_1d[i] = nw_lon + dx*i;
     
     //For Latitude
-    // [0] = North lat; [last] = South lat
+    // [0] = North lat; [last] = South lat (reversed for swOrigin)
     lat_1d = new float [ny];
     for(int j = 0; j < ny; j++)
-      lat_1d[j] = nw_lat - dy*j;
+      lat_1d[j] = format.swOrigin ? nw_lat - dy*(ny-1-j) : nw_lat - dy*j;
       
     //Set time
     time_1d = new double [1];
@@ -167,8 +170,14 @@ int write_CF_netCDF_2d( string outputfile, string dataType,
       var_dims[1] = lon_dim_ID;
 
       strcpy(charArray, varName.c_str());
-      stat = nc_def_var(file_handle, charArray, NC_FLOAT, 2, var_dims, &varID);
+      stat = nc_def_var(file_handle, charArray,
+                        format.packed() ? NC_SHORT : NC_FLOAT, 2, var_dims, &varID);
       if(soft_check_err_wrt(stat,__LINE__,__FILE__) < 0) write_error = true;
+
+      //netCDF-4: chunked and compressed in place
+      if( !write_error &&
+          (define_storage(file_handle, varID, 2, nx, ny, format) < 0) )
+        write_error = true;
     }
     
     //latitude
@@ -231,9 +240,8 @@ int write_CF_netCDF_2d( string outputfile, string dataType,
     stat = nc_put_att_text(file_handle, varID, "long_name", strlen(charArray), charArray);
     if(soft_check_err_wrt(stat,__LINE__,__FILE__) < 0) write_error = true;
 
-    fltArray[0] = missing_value;
-    stat = nc_put_att_float(file_handle, varID, "_FillValue", NC_FLOAT, 1, fltArray);
-    if(soft_check_err_wrt(stat,__LINE__,__FILE__) < 0) write_error = true;
+    stat = write_fill_value(file_handle, varID, missing_value, format);
+    if(stat < 0) write_error = true;
     
     
     //For latitude
@@ -359,8 +367,8 @@ int write_CF_netCDF_2d( string outputfile, string dataType,
     if(!write_error)
     {
       //Write out main variable data
-      stat = nc_put_var_float(file_handle, varID, data_1D);
-      if(soft_check_err_wrt(stat,__LINE__,__FILE__) < 0) write_error = true;
+      stat = write_levels(file_handle, varID, 2, -1, nx, ny, 1, levels, format);
+      if(stat < 0) write_error = true;
     }
     
     if(!write_error)
@@ -392,15 +400,12 @@ int write_CF_netCDF_2d( string outputfile, string dataType,
     nc_close(file_handle);
     
     
-    //gzip file
-    if(gzip_flag)
-    {
-      int length = outputfile.length() + 25;
-      char command[ length ];
-    
-      sprintf(command, "gzip -f -q %s", outputfile.c_str());       
-      system( command );
-    }
+    //gzip file (in process, on the shared pool's threads; see
+    //mrms_deflate.h)
+    if( gzip_flag &&
+        (mrms_gzip_file(outputfile.c_str(), MRMS_GZIP_LEVEL,
+                        &ThreadPool::shared()) < 0) )
+      write_error = true;
     
 
 
@@ -6,6 +6,7 @@
 #include <netcdf.h>
 
 #include "func_prototype.h"
+#include "mrms_deflate.h"
 
 using namespace std;
 
@@ -43,8 +44,12 @@ using namespace std;
 				fractional_time = sub-second valid time of field
 				missing_value = missing data flag
 				range_folded_value = range folded data flag
-				data_1D = set of 2D data fields stored as a row-major 1D array
+				levels = supplies the data one level at a time (each a
+				         row-major 2D field), so the whole cube is
+				         never held in memory
 				gzip_flag = set to 1 and function will gzip output.
+				format = row order, whether values are packed, and
+				         file format (see OutputFormat.h)
 	                               
 	Output:		Single variable CF-compliant netCDF
 				int indicating success or failure
@@ -57,21 +62,21 @@ int write_CF_netCDF_3d( string outputfile, string dataType,
                    float nw_lat, float nw_lon, float heights[],
                    long epoch_time, float fractional_time,
                    float missing_value, float range_folded_value,
-                   float* data_1D, int gzip_flag )
+                   LevelSource &levels, int gzip_flag,
+                   const OutputFormat &format )
 {
     /*-----------------------------*/
     /*** 0. Handle trivial cases ***/
     /*-----------------------------*/
 
-    //No data field
-    if(data_1D == 0) return 0;
-    
-
     //Try to create and open the NetCDF output file 
     int file_handle;
     //int stat = nc_create(outputfile.c_str(), NC_CLOBBER, &file_handle);
-    int stat = nc_create(outputfile.c_str(), NC_64BIT_OFFSET, &file_handle);
     //Need to use NC_64BIT_OFFSET because the resulting file is likely huge!
+    //Grids over 4 GiB (about 1 billion cells) need NC_64BIT_DATA
+    size_t var_bytes = (size_t)nx * (size_t)ny * (size_t)nz * format.valueBytes();
+    int stat = nc_create(outputfile.c_str(),
+                         create_mode(var_bytes, NC_64BIT_OFFSET, format), &file_handle);
     //http://www.unidata.ucar.edu/software/netcdf/docs/netcdf/Large-File-Support.html
     //http://www.unidata.ucar.edu/software/netcdf/docs/netcdf-c/nc_005fcreate.html
     check_err(stat,__LINE__,__FILE__); //exit if fail
@@ -133,10 +138,10 @@ int write_CF_netCDF_3d( string outputfile, string dataType,
       lon_1d[i] = nw_lon + dx*i;
     
     //For Latitude
-    // [0] = North lat; [last] = South lat
+    // [0] = North lat; [last] = South lat (reversed for swOrigin)
     lat_1d = new float [ny];
     for(int j = 0; j < ny; j++)
-      lat_1d[j] = nw_lat - dy*j;
+      lat_1d[j] = format.swOrigin ? nw_lat - dy*(ny-1-j) : nw_lat - dy*j;
       
     //Set time
     time_1d = new double [1];
@@ -175,8 +180,14 @@ int write_CF_netCDF_3d( string outputfile, string dataType,
       var_dims[2] = lon_dim_ID;
 
       strcpy(charArray, varName.c_str());
-      stat = nc_def_var(file_handle, charArray, NC_FLOAT, 3, var_dims, &varID);
+      stat = nc_def_var(file_handle, charArray,
+                        format.packed() ? NC_SHORT : NC_FLOAT, 3, var_dims, &varID);
       if(soft_check_err_wrt(stat,__LINE__,__FILE__) < 0) write_error = true;
+
+      //netCDF-4: chunked and compressed in place
+      if( !write_error &&
+          (define_storage(file_handle, varID, 3, nx, ny, format) < 0) )
+        write_error = true;
     }
 
     //height
@@ -250,9 +261,8 @@ int write_CF_netCDF_3d( string outputfile, string dataType,
     stat = nc_put_att_text(file_handle, varID, "long_name", strlen(charArray), charArray);
     if(soft_check_err_wrt(stat,__LINE__,__FILE__) < 0) write_error = true;
 
-    fltArray[0] = missing_value;
-    stat = nc_put_att_float(file_handle, varID, "_FillValue", NC_FLOAT, 1, fltArray);
-    if(soft_check_err_wrt(stat,__LINE__,__FILE__) < 0) write_error = true;
+    stat = write_fill_value(file_handle, varID, missing_value, format);
+    if(stat < 0) write_error = true;
 
     
     //For height
@@ -387,10 +397,9 @@ int write_CF_netCDF_3d( string outputfile, string dataType,
 
     if(!write_error)
     {
-      //Write out main variable data
-      stat = nc_put_var_float(file_handle, varID, data_1D);
-      if(soft_check_err_wrt(stat,__LINE__,__FILE__) < 0) write_error = true;
-            
+      //Write out main variable data, one level at a time
+      stat = write_levels(file_handle, varID, 3, 0, nx, ny, nz, levels, format);
+      if(stat < 0) write_error = true;
     }
     
     if(!write_error)
@@ -427,15 +436,12 @@ int write_CF_netCDF_3d( string outputfile, string dataType,
     nc_close(file_handle);
     
     
-    //gzip file
-    if(gzip_flag)
-    {
-      int length = outputfile.length() + 25;
-      char command[ length ];
-    
-      sprintf(command, "gzip -f -q %s", outputfile.c_str());       
-      system( command );
-    }
+    //gzip file (in process, on the shared pool's threads; see
+    //mrms_deflate.h)
+    if( gzip_flag &&
+        (mrms_gzip_file(outputfile.c_str(), MRMS_GZIP_LEVEL,
+                        &ThreadPool::shared()) < 0) )
+      write_error = true;
       
 
 
@@ -6,10 +6,25 @@
 #include <string>
 #include <string.h>
 #include <cstdlib>
+#include <cmath>
 #include <netcdf.h>
 #include <vector>
 
+//netcdf_meta.h (netCDF 4.4 and later) gives the library version
+#if defined(__has_include)
+#if __has_include(<netcdf_meta.h>)
+#include <netcdf_meta.h>
+#endif
+#endif
+
+//nc_inq_filter_avail is new in netCDF 4.8.0
+#if defined(NC_VERSION_MAJOR) && defined(NC_VERSION_MINOR) && \
+    ( (NC_VERSION_MAJOR > 4) || ((NC_VERSION_MAJOR == 4) && (NC_VERSION_MINOR >= 8)) )
+#define MRMS_HAVE_FILTER_AVAIL 1
+#endif
+
 #include "HeaderAttribute.h"
+#include "func_prototype.h"
 
 
 using namespace std;
@@ -82,6 +97,169 @@ int soft_check_err_wrt(const int stat, const int line, const char *file)
 
 
 
+/*------------------------------------------------------------------
+
+	Function:	large_file_mode
+		
+	Purpose:	Pick the nc_create mode for a file whose largest
+	            variable takes var_bytes.  Classic files hold
+	            variables up to 2 GiB and 64-bit offset files up
+	            to 4 GiB; anything larger is written as CDF-5
+	            (NC_64BIT_DATA, netCDF 4.4 and later).
+				
+	Input:		var_bytes = size of the largest variable in bytes
+	
+	      		mode = mode the caller would use otherwise
+	      		       (NC_CLOBBER or NC_64BIT_OFFSET)
+				
+	Output:		mode, or a larger-file mode if var_bytes needs one
+	
+------------------------------------------------------------------*/
+
+int large_file_mode(size_t var_bytes, int mode)
+{
+    const size_t classic_max = ((size_t)1 << 31) - 4;
+    const size_t offset_max = ((size_t)1 << 32) - 4;
+
+    if(var_bytes > offset_max) return NC_64BIT_DATA;
+    if( (var_bytes > classic_max) && (mode == NC_CLOBBER) )
+      return NC_64BIT_OFFSET;
+
+    return mode;
+}
+
+
+
+/*------------------------------------------------------------------
+
+	Function:	create_mode
+		
+	Purpose:	Pick the nc_create mode for a file written in
+	            format: netCDF-4 (classic model), or else as
+	            large_file_mode picks.
+				
+	Input:		var_bytes = size of the largest variable in bytes
+	
+	      		mode = mode the caller would use for a classic file
+	      		format = how the file is laid out
+				
+	Output:		mode to create the file with
+	
+------------------------------------------------------------------*/
+
+int create_mode(size_t var_bytes, int mode, const OutputFormat &format)
+{
+    if(format.netcdf4) return (NC_CLOBBER | NC_NETCDF4 | NC_CLASSIC_MODEL);
+
+    return large_file_mode(var_bytes, mode);
+}
+
+
+
+/*------------------------------------------------------------------
+
+	Function:	define_filter
+		
+	Purpose:	Add a plugin filter to a variable's filter chain.
+	            netCDF 4.8 and later are asked first whether the
+	            plugin can be loaded; older versions report it by
+	            failing nc_def_var_filter.
+				
+	Input:		file_handle = a file handle for an open NetCDF file
+	            (in define mode)
+	            varID = ID of the variable
+	            filter = the plugin filter
+				
+	Output:		int indicating success (1) or failure (-1)
+	
+------------------------------------------------------------------*/
+
+static int define_filter(int file_handle, int varID, const OutputFilter &filter)
+{
+#ifdef MRMS_HAVE_FILTER_AVAIL
+    if( nc_inq_filter_avail(file_handle, filter.id()) != NC_NOERR ) return -1;
+#endif
+
+    int stat = nc_def_var_filter(file_handle, varID, filter.id(),
+                                 filter.params().size(), filter.params().data());
+
+    return (stat == NC_NOERR) ? 1 : -1;
+}
+
+
+
+/*------------------------------------------------------------------
+
+	Function:	define_storage
+		
+	Purpose:	Set the chunk shape and compression of the main
+	            variable of a netCDF-4 file: chunks of one level,
+	            format.chunkRows x chunkCols cells (cut to the
+	            grid), shuffled and then compressed by format's
+	            filter.  A plugin filter netCDF cannot load is
+	            reported and replaced by deflate.  Nothing to do
+	            for classic files.
+				
+	Input:		file_handle = a file handle for an open NetCDF file
+	            (in define mode)
+	            varID = ID of the main variable
+	            ndims = number of its dimensions (2 to 4); the last
+	                    two are rows and columns
+	            nx, ny = number of columns and rows
+	            format = how the file is laid out
+				
+	Output:		int indicating success (1) or failure (-1)
+	
+------------------------------------------------------------------*/
+
+int define_storage(int file_handle, int varID, int ndims, int nx, int ny,
+                   const OutputFormat &format)
+{
+    if( !format.netcdf4 ) return 1;
+    if( (ndims < 2) || (ndims > 4) ) return -1;
+
+    size_t chunks[4] = {1, 1, 1, 1};
+    chunks[ndims-2] = ( (format.chunkRows == 0) || (format.chunkRows > (size_t)ny) ) ?
+                      (size_t)ny : format.chunkRows;
+    chunks[ndims-1] = ( (format.chunkCols == 0) || (format.chunkCols > (size_t)nx) ) ?
+                      (size_t)nx : format.chunkCols;
+
+    int stat = nc_def_var_chunking(file_handle, varID, NC_CHUNKED, chunks);
+    if(soft_check_err_wrt(stat,__LINE__,__FILE__) < 0) return -1;
+
+    const OutputFilter &filter = format.filter;
+
+    if( filter.plugin() )
+    {
+      //byte shuffle first (Blosc shuffles for itself)
+      if( format.shuffle && !filter.ownShuffle() )
+      {
+        stat = nc_def_var_deflate(file_handle, varID, 1, 0, 0);
+        if(soft_check_err_wrt(stat,__LINE__,__FILE__) < 0) return -1;
+      }
+
+      if( define_filter(file_handle, varID, filter) > 0 ) return 1;
+
+      cout<<"+++WARNING: Compression filter "<<filter.name()<<" is not "
+          <<"available (see HDF5_PLUGIN_PATH); using deflate"<<endl;
+    }
+
+    //shuffle and deflate, or deflate in place of a missing plugin
+    int deflate_level = (filter.deflateLevel() >= 0) ? filter.deflateLevel() :
+                                                       format.deflateLevel;
+
+    if( (deflate_level > 0) || format.shuffle )
+    {
+      stat = nc_def_var_deflate(file_handle, varID, format.shuffle ? 1 : 0,
+                                (deflate_level > 0) ? 1 : 0, deflate_level);
+      if(soft_check_err_wrt(stat,__LINE__,__FILE__) < 0) return -1;
+    }
+
+    return 1;
+}
+
+
+
 /*------------------------------------------------------------------
 
 	Method:		  write_extra_attributes
@@ -161,4 +339,131 @@ int write_extra_attributes(int file_handle, int varID,
     
 }//end function write_extra_attributes
 
+
+
+/*------------------------------------------------------------------
+
+	Function:	write_fill_value
+		
+	Purpose:	Write the _FillValue attribute of the main
+	            variable, in the variable's type.  Packed variables
+	            also get the CF scale_factor that unpacks them.
+				
+	Input:		file_handle = a file handle for an open NetCDF file
+	            (in define mode)
+	            varID = ID of the main variable
+	            missing_value = missing data flag (unpacked)
+	            format = how the variable is laid out
+				
+	Output:		int indicating success (1) or failure (-1)
+	
+------------------------------------------------------------------*/
+
+int write_fill_value(int file_handle, int varID, float missing_value,
+                     const OutputFormat &format)
+{
+    int stat;
+
+    if( !format.packed() )
+    {
+      float fltArray[1] = { missing_value };
+      stat = nc_put_att_float(file_handle, varID, "_FillValue", NC_FLOAT, 1, fltArray);
+      if(soft_check_err_wrt(stat,__LINE__,__FILE__) < 0) return -1;
+
+      return 1;
+    }
+
+    short int shortArray[1];
+    shortArray[0] = (short int)lround( (double)missing_value * format.packScale );
+    stat = nc_put_att_short(file_handle, varID, "_FillValue", NC_SHORT, 1, shortArray);
+    if(soft_check_err_wrt(stat,__LINE__,__FILE__) < 0) return -1;
+
+    float fltArray[1] = { 1.0f / (float)format.packScale };
+    stat = nc_put_att_float(file_handle, varID, "scale_factor", NC_FLOAT, 1, fltArray);
+    if(soft_check_err_wrt(stat,__LINE__,__FILE__) < 0) return -1;
+
+    return 1;
+}
+
+
+
+/*------------------------------------------------------------------
+
+	Function:	write_levels
+		
+	Purpose:	Write the main variable one level (ny x nx) at a
+	            time, as levels hands them out: the stored short
+	            ints if the variable is packed, else floats through
+	            a level buffer reused from file to file (see
+	            MrmsBufferPool.h).
+				
+	Input:		file_handle = a file handle for an open NetCDF file
+	            (in data mode)
+	            varID = ID of the main variable
+	            ndims = number of its dimensions (2 to 4); the last
+	                    two are rows and columns, any others have
+	                    length 1
+	            level_dim = index of the level dimension (-1 if the
+	                        variable has none; nz is then 1)
+	            nx, ny, nz = number of columns, rows and levels
+	            levels = supplies the data
+	            format = how the variable is laid out
+				
+	Output:		int indicating success (1) or failure (-1)
+	
+------------------------------------------------------------------*/
+
+int write_levels(int file_handle, int varID, int ndims, int level_dim,
+                 int nx, int ny, int nz, LevelSource &levels,
+                 const OutputFormat &format)
+{
+    //at most [time][level][row][column]
+    size_t start[4], count[4];
+    if( (ndims < 2) || (ndims > 4) ) return -1;
+
+    for(int d = 0; d < ndims; d++)
+    {
+      start[d] = 0;
+      count[d] = 1;
+    }
+    count[ndims-2] = ny;
+    count[ndims-1] = nx;
+
+    float *level_data = 0;
+    if( !format.packed() )
+    {
+      level_data = MrmsBufferPool::shared().acquireArray< float >( (size_t)nx*ny );
+      if(level_data == 0) return -1;
+    }
+
+    int result = 1;
+
+    for(int k = 0; (k < nz) && (result > 0); k++)
+    {
+      if(level_dim >= 0) start[level_dim] = k;
+
+      const short int *packed_data = 0;
+      if(format.packed()) packed_data = levels.getPackedLevel(k);
+
+      if( format.packed() ? (packed_data == 0) : (levels.getLevel(k, level_data) < 0) )
+      {
+        cout<<"+++ERROR: Failed to read level "<<k<<" of the input"<<endl;
+        result = -1;
+        continue;
+      }
+
+      int stat;
+      if(format.packed())
+        stat = nc_put_vara_short(file_handle, varID, start, count, packed_data);
+      else
+        stat = nc_put_vara_float(file_handle, varID, start, count, level_data);
+
+      if(soft_check_err_wrt(stat,__LINE__,__FILE__) < 0) result = -1;
+    }
+
+    MrmsBufferPool::shared().release(level_data);
+
+    return result;
+}
+
 #endif